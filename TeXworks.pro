@@ -31,7 +31,10 @@ UI_DIR      = ./ui
 RCC_DIR     = ./rcc
 
 # comment this out if poppler's xpdf headers are not available on the build system
-QMAKE_CXXFLAGS += -DHAVE_POPPLER_XPDF_HEADERS
+# (on Unix-ish platforms, they are used if they are found; see below)
+!unix|macx {
+	QMAKE_CXXFLAGS += -DHAVE_POPPLER_XPDF_HEADERS
+}
 
 # maximum compression for resources (unless that only produces a 5% size decrease)
 QMAKE_RESOURCE_FLAGS += -threshold 5 -compress 9
@@ -106,6 +109,14 @@ unix:!macx { # on Unix-ish platforms we rely on pkgconfig, and use dbus
 	PKGCONFIG	+= poppler-qt4
 	PKGCONFIG	+= zlib
 
+	# poppler's xpdf headers belong to the poppler package, but are not always
+	# installed with it
+	POPPLER_INCLUDEDIR = $$system(pkg-config --variable=includedir poppler)
+	exists($$POPPLER_INCLUDEDIR/poppler/PDFDoc.h) {
+		PKGCONFIG	+= poppler
+		QMAKE_CXXFLAGS += -DHAVE_POPPLER_XPDF_HEADERS
+	}
+
 	# Enclose the path in \\\" (which later gets expanded to \", which in turn
 	# gets expanded to " in the c++ code)
 	QMAKE_CXXFLAGS += -DTW_HELPPATH=\\\"$$TW_HELPPATH\\\"
@@ -155,6 +166,8 @@ win32 { # paths here are specific to my setup
 # Input
 HEADERS	+=	src/TWApp.h \
 			src/TWUtils.h \
+			src/TWDocumentText.h \
+			src/TWSpellChecker.h \
 			src/TWScriptable.h \
 			src/TWScript.h \
 			src/TWScriptAPI.h \
@@ -162,10 +175,18 @@ HEADERS	+=	src/TWApp.h \
 			src/CommandlineParser.h \
 			src/CompletingEdit.h \
 			src/TeXHighlighter.h \
+			src/TeXDelimiterIndex.h \
 			src/TeXDocks.h \
 			src/PDFDocument.h \
 			src/PDFDocks.h \
+			src/PDFRenderer.h \
+			src/PDFTextLayer.h \
+			src/SyncTeXIndex.h \
 			src/FindDialog.h \
+			src/TWTextSearch.h \
+			src/TWProjectSearch.h \
+			src/TWTagIndex.h \
+			src/TWTagsModel.h \
 			src/PrefsDialog.h \
 			src/TemplateDialog.h \
 			src/HardWrapDialog.h \
@@ -174,8 +195,6 @@ HEADERS	+=	src/TWApp.h \
 			src/ConfirmDelete.h \
 			src/TWVersion.h \
 			src/SvnRev.h \
-			src/synctex_parser.h \
-			src/synctex_parser_utils.h \
 			src/ClickableLabel.h \
 			src/ConfigurableApp.h \
 			src/TWSystemCmd.h
@@ -197,6 +216,8 @@ FORMS	+=	src/TeXDocument.ui \
 SOURCES	+=	src/main.cpp \
 			src/TWApp.cpp \
 			src/TWUtils.cpp \
+			src/TWDocumentText.cpp \
+			src/TWSpellChecker.cpp \
 			src/TWScriptable.cpp \
 			src/TWScript.cpp \
 			src/TWScriptAPI.cpp \
@@ -204,18 +225,24 @@ SOURCES	+=	src/main.cpp \
 			src/CommandlineParser.cpp \
 			src/CompletingEdit.cpp \
 			src/TeXHighlighter.cpp \
+			src/TeXDelimiterIndex.cpp \
 			src/TeXDocks.cpp \
 			src/PDFDocument.cpp \
 			src/PDFDocks.cpp \
+			src/PDFRenderer.cpp \
+			src/PDFTextLayer.cpp \
+			src/SyncTeXIndex.cpp \
 			src/FindDialog.cpp \
+			src/TWTextSearch.cpp \
+			src/TWProjectSearch.cpp \
+			src/TWTagIndex.cpp \
+			src/TWTagsModel.cpp \
 			src/PrefsDialog.cpp \
 			src/TemplateDialog.cpp \
 			src/HardWrapDialog.cpp \
 			src/ResourcesDialog.cpp \
 			src/ScriptManager.cpp \
-			src/ConfirmDelete.cpp \
-			src/synctex_parser.c \
-			src/synctex_parser_utils.c
+			src/ConfirmDelete.cpp
 
 RESOURCES	+=	res/resources.qrc \
 				res/resfiles.qrc
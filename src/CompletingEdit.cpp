@@ -22,6 +22,9 @@
 #include "CompletingEdit.h"
 #include "TWUtils.h"
 #include "TWApp.h"
+#include "TWDocumentText.h"
+#include "TeXDelimiterIndex.h"
+#include "TWSpellChecker.h"
 
 #include <QCompleter>
 #include <QKeyEvent>
@@ -353,18 +356,16 @@ QTextCursor CompletingEdit::wordSelectionForPos(const QPoint& mousePos)
 		// don't test because the rect will be zero width (see above)!
 		//		r = cursorRect(cursor);
 		//		if (r.contains(pos)) {
-		const QString plainText = toPlainText();
-		QChar curChr = plainText[cursorPos];
-		QChar c;
-		if ((c = TWUtils::closerMatching(curChr)) != 0) {
-			int balancePos = TWUtils::balanceDelim(plainText, cursorPos + 1, c, 1);
+		QChar curChr = document()->characterAt(cursorPos);
+		if (TWUtils::openerMatching(curChr) == 0 && TWUtils::closerMatching(curChr) != 0) {
+			int balancePos = TeXDelimiterIndex::forDocument(document())->matchingDelimiter(cursorPos);
 			if (balancePos < 0)
 				QApplication::beep();
 			else
 				cursor.setPosition(balancePos + 1, QTextCursor::KeepAnchor);
 				}
-		else if ((c = TWUtils::openerMatching(curChr)) != 0) {
-			int balancePos = TWUtils::balanceDelim(plainText, cursorPos - 1, c, -1);
+		else if (TWUtils::openerMatching(curChr) != 0) {
+			int balancePos = TeXDelimiterIndex::forDocument(document())->matchingDelimiter(cursorPos);
 			if (balancePos < 0)
 				QApplication::beep();
 			else {
@@ -521,13 +522,7 @@ void CompletingEdit::handleOtherKey(QKeyEvent *e)
 			if (cursor.selectionStart() == pos + 1 || cursor.selectionStart() == pos - 1) {
 				if (cursor.selectionStart() == pos - 1) // we moved backward, set pos to look at the char we just passed over
 					--pos;
-				const QString text = document()->toPlainText();
-				int match = -2;
-				QChar c;
-				if (pos > 0 && pos < text.length() && (c = TWUtils::openerMatching(text[pos])) != 0)
-					match = TWUtils::balanceDelim(text, pos - 1, c, -1);
-				else if (pos < text.length() - 1 && (c = TWUtils::closerMatching(text[pos])) != 0)
-					match = TWUtils::balanceDelim(text, pos + 1, c, 1);
+				int match = TeXDelimiterIndex::forDocument(document())->matchingDelimiter(pos);
 				if (match >= 0) {
 					QList<ExtraSelection> selList = extraSelections();
 					ExtraSelection	sel;
@@ -606,7 +601,7 @@ void CompletingEdit::maybeSmartenQuote(int offset)
 	const QuoteMapping& mappings = quotesModes->at(smartQuotesMode).mappings;
 	QString replacement;
 
-	const QString& text = document()->toPlainText();
+	const TWDocumentText text(document());
 	if (offset < 0 || offset >= text.length())
 		return;
 	QTextCursor cursor(document());
@@ -641,7 +636,7 @@ void CompletingEdit::smartenQuotes()
 		return;
 	const QuoteMapping& mappings = quotesModes->at(smartQuotesMode).mappings;
 
-	const QString& text = document()->toPlainText();
+	TWDocumentText text(document());
 
 	QTextCursor curs = textCursor();
 	int selStart = curs.selectionStart();
@@ -663,6 +658,7 @@ void CompletingEdit::smartenQuotes()
 		const QString& replacement((offset == 0 || text[offset - 1].isSpace()) ?
 								   iter.value().first : iter.value().second);
 		curs.insertText(replacement);
+		text.reset();
 		selEnd += replacement.length() - 1;
 	}
 	if (changed) {
@@ -919,27 +915,23 @@ void CompletingEdit::contextMenuEvent(QContextMenuEvent *event)
 		currentWord = cursorForPosition(event->pos());
 		currentWord.setPosition(currentWord.position());
 		if (selectWord(currentWord)) {
-			QByteArray word = spellingCodec->fromUnicode(currentWord.selectedText());
-			int spellResult = Hunspell_spell(pHunspell, word.data());
-			if (spellResult == 0) {
-				char **suggestionList;
-				int count = Hunspell_suggest(pHunspell, &suggestionList, word.data());
+			TWSpellChecker *spellChecker = TWSpellChecker::instance();
+			QString word = currentWord.selectedText();
+			if (!spellChecker->isWordCorrect(pHunspell, spellingCodec, word)) {
+				QStringList suggestions = spellChecker->suggestions(pHunspell, spellingCodec, word);
 				QAction *sep = menu->insertSeparator(menu->actions().first());
-				if (count == 0)
+				if (suggestions.isEmpty())
 					menu->insertAction(sep, new QAction(tr("No suggestions"), menu));
 				else {
 					QSignalMapper *mapper = new QSignalMapper(menu);
-					for (int i = 0; i < count; ++i) {
-						QString str = spellingCodec->toUnicode(suggestionList[i]);
+					foreach (const QString& str, suggestions) {
 						act = new QAction(str, menu);
 						connect(act, SIGNAL(triggered()), mapper, SLOT(map()));
 						mapper->setMapping(act, str);
 						menu->insertAction(sep, act);
-						free(suggestionList[i]);
 						if (!defaultAction)
 							defaultAction = act;
 					}
-					free(suggestionList);
 					connect(mapper, SIGNAL(mapped(const QString&)), this, SLOT(correction(const QString&)));
 				}
 				sep = menu->insertSeparator(menu->actions().first());
@@ -981,10 +973,9 @@ void CompletingEdit::addToDictionary()
 
 void CompletingEdit::ignoreWord()
 {
-	// note that this is not persistent after quitting TW
-	QByteArray word = spellingCodec->fromUnicode(currentWord.selectedText());
-	(void)Hunspell_add(pHunspell, word.data());
-	emit rehighlight();
+	// note that this is not persistent after quitting TW; highlighters
+	// update the affected blocks when TWSpellChecker emits wordIgnored()
+	TWSpellChecker::instance()->ignoreWord(pHunspell, spellingCodec, currentWord.selectedText());
 }
 
 void CompletingEdit::loadIndentModes()
@@ -1113,6 +1104,7 @@ void CompletingEdit::resizeEvent(QResizeEvent *e)
 	
 	QRect cr = contentsRect();
 	lineNumberArea->setGeometry(QRect(cr.left(), cr.top(), lineNumberAreaWidth(), cr.height()));
+	emit resized();
 }
 
 void CompletingEdit::lineNumberAreaPaintEvent(QPaintEvent *event)
@@ -73,8 +73,8 @@ public slots:
 	
 signals:
 	void syncClick(int);
-	void rehighlight();
 	void updateRequest(const QRect& rect, int dy);
+	void resized();
 
 protected:
 	virtual void keyPressEvent(QKeyEvent *e);
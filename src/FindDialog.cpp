@@ -23,9 +23,10 @@
 #include "TeXDocument.h"
 #include "PDFDocument.h"
 #include "TWApp.h"
+#include "TWTextSearch.h"
 
 #include <QPushButton>
-#include <QTableWidget>
+#include <QTableView>
 #include <QHeaderView>
 #include <QTextBlock>
 #include <QFileInfo>
@@ -252,6 +253,8 @@ void ReplaceDialog::init(QTextEdit *document)
 	connect(buttonBox->button(QDialogButtonBox::Ok), SIGNAL(clicked()), this, SLOT(clickedReplace()));
 	buttonBox->button(QDialogButtonBox::SaveAll)->setText(tr("Replace All"));
 	connect(buttonBox->button(QDialogButtonBox::SaveAll), SIGNAL(clicked()), this, SLOT(clickedReplaceAll()));
+	buttonBox->button(QDialogButtonBox::Apply)->setText(tr("Count"));
+	connect(buttonBox->button(QDialogButtonBox::Apply), SIGNAL(clicked()), this, SLOT(clickedCount()));
 	buttonBox->button(QDialogButtonBox::Cancel)->setText(tr("Cancel"));
 	connect(buttonBox->button(QDialogButtonBox::Cancel), SIGNAL(clicked()), this, SLOT(reject()));
 
@@ -368,6 +371,41 @@ void ReplaceDialog::clickedReplaceAll()
 	done(2);
 }
 
+// counts the occurrences "Replace All" would replace, without changing anything
+void ReplaceDialog::clickedCount()
+{
+	QTextDocument::FindFlags flags = 0;
+	if (checkBox_case->isChecked())
+		flags |= QTextDocument::FindCaseSensitively;
+	if (checkBox_words->isChecked() && checkBox_words->isEnabled())
+		flags |= QTextDocument::FindWholeWords;
+	TWTextSearch search(searchText->text(), checkBox_regex->isChecked(), flags);
+	if (!search.isValid()) {
+		countStatus->setText("");
+		return;
+	}
+
+	int count = 0;
+	if (checkBox_allFiles->isEnabled() && checkBox_allFiles->isChecked()) {
+		foreach (TeXDocument* doc, TeXDocument::documentList())
+			count += search.findAll(doc->textDoc()).count();
+		countStatus->setText(tr("%1 in %2").arg(tr("%n occurrence(s)", "", count))
+							 .arg(tr("%n documents", "", TeXDocument::documentList().count())));
+		return;
+	}
+
+	QTextEdit* document = qobject_cast<QTextEdit*>(parent());
+	if (document == NULL)
+		return;
+	if (checkBox_selection->isEnabled() && checkBox_selection->isChecked()) {
+		QTextCursor curs = document->textCursor();
+		count = search.findAll(document->document(), curs.selectionStart(), curs.selectionEnd()).count();
+	}
+	else
+		count = search.findAll(document->document()).count();
+	countStatus->setText(tr("%n occurrence(s)", "", count));
+}
+
 ReplaceDialog::DialogCode ReplaceDialog::doReplaceDialog(QTextEdit *document)
 {
 	ReplaceDialog dlg(document);
@@ -418,13 +456,157 @@ ReplaceDialog::DialogCode ReplaceDialog::doReplaceDialog(QTextEdit *document)
 }
 
 
+QString SearchResult::filePath() const
+{
+	return doc != NULL ? doc->fileName() : fileName;
+}
+
+QString SearchResult::text() const
+{
+	return doc != NULL ? doc->getLineText(lineNo) : lineText;
+}
+
+#define MAXIMUM_CHARACTERS_BEFORE_SEARCH_RESULT 40
+#define MAXIMUM_CHARACTERS_AFTER_SEARCH_RESULT 80
+
+SearchResultsModel::SearchResultsModel(QObject *parent)
+	: QAbstractTableModel(parent)
+{
+}
+
+int SearchResultsModel::rowCount(const QModelIndex& parent) const
+{
+	return parent.isValid() ? 0 : results.count();
+}
+
+int SearchResultsModel::columnCount(const QModelIndex& parent) const
+{
+	return parent.isValid() ? 0 : kNumColumns;
+}
+
+QVariant SearchResultsModel::data(const QModelIndex& index, int role) const
+{
+	if (!index.isValid() || index.row() >= results.count())
+		return QVariant();
+	const SearchResult& result = results[index.row()];
+
+	if (role == Qt::ToolTipRole && index.column() == kFileColumn)
+		return result.filePath();
+	if (role != Qt::DisplayRole)
+		return QVariant();
+
+	switch (index.column()) {
+		case kFileColumn:
+			return QFileInfo(result.filePath()).fileName();
+		case kLineColumn:
+			return result.lineNo;
+		case kStartColumn:
+			return result.selStart;
+		case kEndColumn:
+			return result.selEnd;
+		case kTextColumn:
+			return excerpt(result.text(), result.selStart, result.selEnd);
+	}
+	return QVariant();
+}
+
+QVariant SearchResultsModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+	if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+		return QVariant();
+	switch (section) {
+		case kFileColumn:
+			return tr("File");
+		case kLineColumn:
+			return tr("Line");
+		case kStartColumn:
+			return tr("Start");
+		case kEndColumn:
+			return tr("End");
+		case kTextColumn:
+			return tr("Text");
+	}
+	return QVariant();
+}
+
+void SearchResultsModel::addResults(const QList<SearchResult>& newResults)
+{
+	if (newResults.isEmpty())
+		return;
+	beginInsertRows(QModelIndex(), results.count(), results.count() + newResults.count() - 1);
+	results << newResults;
+	endInsertRows();
+}
+
+QString SearchResultsModel::excerpt(const QString& line, int start, int end)
+{
+	// Only show a limited number of characters before and after the
+	// specified search string to keep the results clear
+	bool truncateStart = true, truncateEnd = true;
+	int iStart, iEnd;
+	QString text = line;
+	iStart = start - MAXIMUM_CHARACTERS_BEFORE_SEARCH_RESULT;
+	iEnd = end + MAXIMUM_CHARACTERS_AFTER_SEARCH_RESULT;
+	if (iStart < 0) {
+		iStart = 0;
+		truncateStart = false;
+	}
+	if (iEnd > text.length()) {
+		iEnd = text.length();
+		truncateEnd = false;
+	}
+#if QT_VERSION >= 0x040400 // QTextBoundaryFinder is new in Qt 4.4
+	if (truncateStart || truncateEnd) {
+		// ensure the truncation happens on appropriate boundaries, not mid-cluster
+		QTextBoundaryFinder tbf(QTextBoundaryFinder::Grapheme, text);
+		if (truncateStart) {
+			tbf.setPosition(iStart);
+			if (!tbf.isAtBoundary()) {
+				tbf.toPreviousBoundary();
+				iStart = tbf.position();
+			}
+		}
+		if (truncateEnd) {
+			tbf.setPosition(iEnd);
+			if (!tbf.isAtBoundary()) {
+				tbf.toNextBoundary();
+				iEnd = tbf.position();
+			}
+		}
+	}
+#endif
+	text = text.mid(iStart, iEnd - iStart);
+	if (truncateStart)
+		text.prepend(tr("..."));
+	if (truncateEnd)
+		text.append(tr("..."));
+	return text;
+}
+
+// rows all have the height of one line of text, so the view never needs to
+// measure them
+static void setFixedRowHeight(QTableView *table)
+{
+	table->verticalHeader()->setResizeMode(QHeaderView::Fixed);
+	table->verticalHeader()->setDefaultSectionSize(table->fontMetrics().lineSpacing() + 4);
+	table->verticalHeader()->hide();
+}
+
 SearchResults::SearchResults(QWidget* parent)
 	: QDockWidget(parent)
+	, searching(false)
 {
 	setupUi(this);
-	connect(table, SIGNAL(itemSelectionChanged()), this, SLOT(showSelectedEntry()));
-	connect(table, SIGNAL(itemPressed(QTableWidgetItem*)), this, SLOT(showEntry(QTableWidgetItem*)));
-	connect(table, SIGNAL(itemActivated(QTableWidgetItem*)), this, SLOT(goToSource()));
+	model = new SearchResultsModel(this);
+	table->setModel(model);
+	table->horizontalHeader()->setResizeMode(SearchResultsModel::kTextColumn, QHeaderView::Stretch);
+	table->setColumnHidden(SearchResultsModel::kStartColumn, true);
+	table->setColumnHidden(SearchResultsModel::kEndColumn, true);
+	setFixedRowHeight(table);
+
+	connect(table->selectionModel(), SIGNAL(selectionChanged(const QItemSelection&, const QItemSelection&)), this, SLOT(showSelectedEntry()));
+	connect(table, SIGNAL(pressed(const QModelIndex&)), this, SLOT(showEntry(const QModelIndex&)));
+	connect(table, SIGNAL(activated(const QModelIndex&)), this, SLOT(goToSource()));
 	QShortcut *sc;
 	sc = new QShortcut(Qt::Key_Escape, table);
 	sc->setContext(Qt::WidgetShortcut);
@@ -441,15 +623,10 @@ SearchResults::SearchResults(QWidget* parent)
 
 void SearchResults::goToSource()
 {
-	QList<QTableWidgetSelectionRange> ranges = table->selectedRanges();
-	if (ranges.count() == 0)
-		return;
-	int row = ranges.first().topRow();
-	QString fileName;
-	QTableWidgetItem* item = table->item(row, 0);
-	if (!item)
+	QModelIndexList rows = table->selectionModel()->selectedRows();
+	if (rows.count() == 0)
 		return;
-	fileName = item->toolTip();
+	QString fileName = model->result(rows.first().row()).filePath();
 	
 	if (!fileName.isEmpty()) {
 		QWidget *theDoc = TeXDocument::openDocument(fileName);
@@ -467,12 +644,9 @@ void SearchResults::goToSourceAndClose()
 	deleteLater();
 }
 
-#define MAXIMUM_CHARACTERS_BEFORE_SEARCH_RESULT 40
-#define MAXIMUM_CHARACTERS_AFTER_SEARCH_RESULT 80
-
-void SearchResults::presentResults(const QString& searchText,
-								   const QList<SearchResult>& results,
-								   QMainWindow* parent, bool singleFile)
+SearchResults *SearchResults::presentResults(const QString& searchText,
+											 const QList<SearchResult>& results,
+											 QMainWindow* parent, bool singleFile)
 {
 	if (singleFile) {
 		// remove any existing results dock from this parent window
@@ -484,72 +658,8 @@ void SearchResults::presentResults(const QString& searchText,
 	}
 
 	SearchResults* resultsWindow = new SearchResults(parent);
-	resultsWindow->setWindowTitle(tr("Search Results - %1 (%2 found)").arg(searchText).arg(results.count()));
-
-	resultsWindow->table->setRowCount(results.count());
-	int i = 0;
-	foreach (const SearchResult &result, results) {
-		QTableWidgetItem *item = new QTableWidgetItem(QFileInfo(result.doc->fileName()).fileName());
-		item->setToolTip(result.doc->fileName());
-		resultsWindow->table->setItem(i, 0, item);
-		resultsWindow->table->setItem(i, 1, new QTableWidgetItem(QString::number(result.lineNo)));
-		resultsWindow->table->setItem(i, 2, new QTableWidgetItem(QString::number(result.selStart)));
-		resultsWindow->table->setItem(i, 3, new QTableWidgetItem(QString::number(result.selEnd)));
-
-		// Only show a limited number of characters before and after the
-		// specified search string to keep the results clear
-		bool truncateStart = true, truncateEnd = true;
-		int iStart, iEnd;
-		QString text = result.doc->getLineText(result.lineNo);
-		iStart = result.selStart - MAXIMUM_CHARACTERS_BEFORE_SEARCH_RESULT;
-		iEnd = result.selEnd + MAXIMUM_CHARACTERS_AFTER_SEARCH_RESULT;
-		if (iStart < 0) {
-			iStart = 0;
-			truncateStart = false;
-		}
-		if (iEnd > text.length()) {
-			iEnd = text.length();
-			truncateEnd = false;
-		}
-#if QT_VERSION >= 0x040400 // QTextBoundaryFinder is new in Qt 4.4
-		if (truncateStart || truncateEnd) {
-			// ensure the truncation happens on appropriate boundaries, not mid-cluster
-			QTextBoundaryFinder tbf(QTextBoundaryFinder::Grapheme, text);
-			if (truncateStart) {
-				tbf.setPosition(iStart);
-				if (!tbf.isAtBoundary()) {
-					tbf.toPreviousBoundary();
-					iStart = tbf.position();
-				}
-			}
-			if (truncateEnd) {
-				tbf.setPosition(iEnd);
-				if (!tbf.isAtBoundary()) {
-					tbf.toNextBoundary();
-					iEnd = tbf.position();
-				}
-			}
-		}
-#endif
-		text = text.mid(iStart, iEnd - iStart);
-		if (truncateStart)
-			text.prepend(tr("..."));
-		if (truncateEnd)
-			text.append(tr("..."));
-		resultsWindow->table->setItem(i, 4, new QTableWidgetItem(text));
-
-		++i;
-	}
-
-	resultsWindow->table->setHorizontalHeaderLabels(QStringList() << tr("File") << tr("Line") << tr("Start") << tr("End") << tr("Text"));
-	resultsWindow->table->horizontalHeader()->setResizeMode(4, QHeaderView::Stretch);
-	resultsWindow->table->verticalHeader()->setResizeMode(QHeaderView::ResizeToContents);
-	resultsWindow->table->verticalHeader()->hide();
-	resultsWindow->table->setColumnHidden(2, true);
-	resultsWindow->table->setColumnHidden(3, true);
-
-	resultsWindow->table->resizeColumnsToContents();
-	resultsWindow->table->resizeRowsToContents();
+	resultsWindow->searchText = searchText;
+	resultsWindow->addResults(results);
 
 	if (singleFile) {
 		resultsWindow->setAllowedAreas(Qt::TopDockWidgetArea|Qt::BottomDockWidgetArea);
@@ -564,36 +674,53 @@ void SearchResults::presentResults(const QString& searchText,
 	}
 	
 	resultsWindow->show();
+	return resultsWindow;
 }
 
-void SearchResults::showEntry(QTableWidgetItem * item)
+void SearchResults::addResults(const QList<SearchResult>& results)
 {
-	if (!item)
+	bool first = (model->rowCount() == 0);
+	model->addResults(results);
+	// the view only measures the rows in sight, so this doesn't depend on
+	// the number of results
+	if (first && !results.isEmpty()) {
+		table->resizeColumnToContents(SearchResultsModel::kFileColumn);
+		table->resizeColumnToContents(SearchResultsModel::kLineColumn);
+	}
+	updateTitle();
+}
+
+void SearchResults::setSearching(bool isSearching)
+{
+	searching = isSearching;
+	updateTitle();
+}
+
+void SearchResults::updateTitle()
+{
+	if (searching)
+		setWindowTitle(tr("Search Results - %1 (%2 found so far)").arg(searchText).arg(model->rowCount()));
+	else
+		setWindowTitle(tr("Search Results - %1 (%2 found)").arg(searchText).arg(model->rowCount()));
+}
+
+void SearchResults::showEntry(const QModelIndex& index)
+{
+	if (!index.isValid())
 		return;
-	int row = item->row();
-	item = table->item(row, 0);
-	QString fileName = item->toolTip();
-	item = table->item(row, 1);
-	int lineNo = item->text().toInt();
-	item = table->item(row, 2);
-	int selStart = item->text().toInt();
-	item = table->item(row, 3);
-	int selEnd = item->text().toInt();
+	const SearchResult& result = model->result(index.row());
+	QString fileName = result.filePath();
 
 	if (!fileName.isEmpty())
-		TeXDocument::openDocument(fileName, false, true, lineNo, selStart, selEnd);
+		TeXDocument::openDocument(fileName, false, true, result.lineNo, result.selStart, result.selEnd);
 }
 
 void SearchResults::showSelectedEntry()
 {
-	QList<QTableWidgetSelectionRange> ranges = table->selectedRanges();
-	if (ranges.count() == 0)
+	QModelIndexList rows = table->selectionModel()->selectedRows();
+	if (rows.count() == 0)
 		return;
-	int row = ranges.first().topRow();
-	QTableWidgetItem* item = table->item(row, 0);
-	if (!item)
-		return;
-	showEntry(item);
+	showEntry(rows.first());
 }
 
 void SearchResults::focusChanged(QWidget * old, QWidget * now)
@@ -631,9 +758,9 @@ void PDFFindDialog::init(PDFDocument *document)
 	setupUi(this);
 
 	buttonBox->button(QDialogButtonBox::Ok)->setText(tr("Find"));
+	connect(checkBox_findAll, SIGNAL(toggled(bool)), this, SLOT(toggledFindAllOption(bool)));
 /*
 	connect(checkBox_allFiles, SIGNAL(toggled(bool)), this, SLOT(toggledAllFilesOption(bool)));
-	connect(checkBox_findAll, SIGNAL(toggled(bool)), this, SLOT(toggledFindAllOption(bool)));
 	connect(checkBox_regex, SIGNAL(toggled(bool)), this, SLOT(toggledRegexOption(bool)));
 	connect(checkBox_selection, SIGNAL(toggled(bool)), this, SLOT(toggledSelectionOption(bool)));
 	connect(searchText, SIGNAL(textChanged(const QString&)), this, SLOT(checkRegex(const QString&)));
@@ -643,15 +770,9 @@ void PDFFindDialog::init(PDFDocument *document)
 	searchText->setText(str);
 	searchText->selectAll();
 	
-	// if findAll is enabled, revisit the saving of settings in
-	// PDFFindDialog::doFindDialog (and enable saving findAll if it's reasonable
-	// to override the setting (also for searches in the editor))
-	checkBox_findAll->setEnabled(false);
-	bool findAll = false;
-/*
-	bool findAll = settings.value("searchFindAll").toBool();
+	bool findAll = settings.value("pdfSearchFindAll").toBool();
 	checkBox_findAll->setChecked(findAll);
-*/
+
 	bool wrapOption = settings.value("searchWrap").toBool();
 	checkBox_wrap->setEnabled(!findAll);
 	checkBox_wrap->setChecked(wrapOption);
@@ -716,7 +837,7 @@ QDialog::DialogCode PDFFindDialog::doFindDialog(PDFDocument *document)
 //		settings.setValue("searchRegex", dlg.checkBox_regex->isChecked());
 		settings.setValue("searchWrap", dlg.checkBox_wrap->isChecked());
 //		settings.setValue("searchSelection", dlg.checkBox_selection->isChecked());
-//		settings.setValue("searchFindAll", dlg.checkBox_findAll->isChecked());
+		settings.setValue("pdfSearchFindAll", dlg.checkBox_findAll->isChecked());
 //		settings.setValue("searchAllFiles", dlg.checkBox_allFiles->isChecked());
 		settings.setValue("searchPdfSync", dlg.checkBox_sync->isChecked());
 	}
@@ -724,6 +845,11 @@ QDialog::DialogCode PDFFindDialog::doFindDialog(PDFDocument *document)
 	return result;
 }
 
+void PDFFindDialog::toggledFindAllOption(bool checked)
+{
+	checkBox_wrap->setEnabled(!checked);
+}
+
 void PDFFindDialog::setSearchText()
 {
 	QAction *act = qobject_cast<QAction*>(sender());
@@ -733,3 +859,140 @@ void PDFFindDialog::setSearchText()
 	}
 }
 
+
+static bool matchLessThan(const PDFTextMatch& m1, const PDFTextMatch& m2)
+{
+	return m1.pageIdx < m2.pageIdx || (m1.pageIdx == m2.pageIdx && m1.start < m2.start);
+}
+
+PDFSearchResultsModel::PDFSearchResultsModel(QObject *parent)
+	: QAbstractTableModel(parent)
+{
+}
+
+int PDFSearchResultsModel::rowCount(const QModelIndex& parent) const
+{
+	return parent.isValid() ? 0 : matches.count();
+}
+
+int PDFSearchResultsModel::columnCount(const QModelIndex& parent) const
+{
+	return parent.isValid() ? 0 : kNumColumns;
+}
+
+QVariant PDFSearchResultsModel::data(const QModelIndex& index, int role) const
+{
+	if (!index.isValid() || index.row() >= matches.count() || role != Qt::DisplayRole)
+		return QVariant();
+	switch (index.column()) {
+		case kPageColumn:
+			return matches[index.row()].pageIdx + 1;
+		case kTextColumn:
+			return contexts[index.row()];
+	}
+	return QVariant();
+}
+
+QVariant PDFSearchResultsModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+	if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+		return QVariant();
+	switch (section) {
+		case kPageColumn:
+			return tr("Page");
+		case kTextColumn:
+			return tr("Text");
+	}
+	return QVariant();
+}
+
+void PDFSearchResultsModel::addMatches(const QList<PDFTextMatch>& newMatches, const QStringList& newContexts)
+{
+	int first = 0;
+	while (first < newMatches.count()) {
+		int row = qUpperBound(matches.begin(), matches.end(), newMatches[first], matchLessThan) - matches.begin();
+		// extend the run while the matches are sorted and still come before
+		// the existing row
+		int last = first + 1;
+		while (last < newMatches.count() && !matchLessThan(newMatches[last], newMatches[last - 1]) &&
+				(row == matches.count() || matchLessThan(newMatches[last], matches[row])))
+			++last;
+		beginInsertRows(QModelIndex(), row, row + last - first - 1);
+		for (int i = first; i < last; ++i) {
+			matches.insert(row + i - first, newMatches[i]);
+			contexts.insert(row + i - first, newContexts[i]);
+		}
+		endInsertRows();
+		first = last;
+	}
+}
+
+PDFSearchResults::PDFSearchResults(PDFDocument *parent, const QString& text)
+	: QDockWidget(parent)
+	, document(parent)
+	, searchText(text)
+{
+	setupUi(this);
+	model = new PDFSearchResultsModel(this);
+	table->setModel(model);
+	table->horizontalHeader()->setResizeMode(PDFSearchResultsModel::kTextColumn, QHeaderView::Stretch);
+	setFixedRowHeight(table);
+	connect(table->selectionModel(), SIGNAL(selectionChanged(const QItemSelection&, const QItemSelection&)), this, SLOT(showSelectedEntry()));
+	connect(table, SIGNAL(pressed(const QModelIndex&)), this, SLOT(showEntry(const QModelIndex&)));
+	updateTitle();
+}
+
+PDFSearchResults *PDFSearchResults::presentResults(const QString& searchText, PDFDocument *parent)
+{
+	// remove any existing results dock from this window
+	QList<PDFSearchResults*> children = parent->findChildren<PDFSearchResults*>();
+	foreach (PDFSearchResults* child, children) {
+		parent->removeDockWidget(child);
+		child->deleteLater();
+	}
+
+	PDFSearchResults* resultsWindow = new PDFSearchResults(parent, searchText);
+	resultsWindow->setAllowedAreas(Qt::TopDockWidgetArea|Qt::BottomDockWidgetArea);
+	resultsWindow->setFloating(false);
+	parent->addDockWidget(Qt::BottomDockWidgetArea, resultsWindow);
+	resultsWindow->show();
+	return resultsWindow;
+}
+
+void PDFSearchResults::addMatches(const QList<PDFTextMatch>& newMatches, const PDFTextLayer *textLayer)
+{
+	if (newMatches.isEmpty())
+		return;
+	QStringList contexts;
+	foreach (const PDFTextMatch& match, newMatches) {
+		QString context;
+		if (textLayer->hasPage(match.pageIdx))
+			context = textLayer->page(match.pageIdx).context(match, MAXIMUM_CHARACTERS_BEFORE_SEARCH_RESULT,
+															 MAXIMUM_CHARACTERS_AFTER_SEARCH_RESULT);
+		contexts << context;
+	}
+	model->addMatches(newMatches, contexts);
+	table->resizeColumnToContents(PDFSearchResultsModel::kPageColumn);
+	updateTitle();
+}
+
+void PDFSearchResults::updateTitle()
+{
+	setWindowTitle(tr("Search Results - %1 (%2 found)").arg(searchText).arg(model->rowCount()));
+}
+
+void PDFSearchResults::showEntry(const QModelIndex& index)
+{
+	if (!index.isValid() || index.row() >= model->rowCount())
+		return;
+	const PDFTextMatch& match = model->match(index.row());
+	document->showSearchResult(PDFSearchResult(document, match.pageIdx, match.rect));
+}
+
+void PDFSearchResults::showSelectedEntry()
+{
+	QModelIndexList rows = table->selectionModel()->selectedRows();
+	if (rows.count() == 0)
+		return;
+	showEntry(rows.first());
+}
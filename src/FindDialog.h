@@ -25,12 +25,16 @@
 #include <QDialog>
 #include <QDockWidget>
 #include <QList>
+#include <QStringList>
+#include <QAbstractTableModel>
 
 #include "ui_Find.h"
 #include "ui_Replace.h"
 #include "ui_SearchResults.h"
 #include "ui_PDFFind.h"
 
+#include "PDFTextLayer.h"
+
 class TeXDocument;
 class QTextEdit;
 class PDFDocument;
@@ -85,7 +89,7 @@ public:
 	static DialogCode doFindDialog(PDFDocument *document);
 
 private slots:
-//	void toggledFindAllOption(bool checked);
+	void toggledFindAllOption(bool checked);
 	void setSearchText();
 
 private:
@@ -115,6 +119,7 @@ private slots:
 	void checkRegex(const QString& str);
 	void clickedReplace();
 	void clickedReplaceAll();
+	void clickedCount();
 	void setSearchText();
 	void setReplaceText();
 
@@ -128,11 +133,55 @@ public:
 	SearchResult(const TeXDocument* texdoc, int line, int start, int end)
 		: doc(texdoc), lineNo(line), selStart(start), selEnd(end)
 		{ }
+	// a result in a file that need not be open; text is the line's content
+	SearchResult(const QString& file, int line, int start, int end, const QString& text)
+		: doc(NULL), fileName(file), lineNo(line), selStart(start), selEnd(end), lineText(text)
+		{ }
+
+	QString filePath() const;
+	QString text() const;
 
 	const TeXDocument* doc;
+	QString fileName;	// only used if doc is NULL
 	int lineNo;
 	int selStart;
 	int selEnd;
+	QString lineText;	// only used if doc is NULL
+};
+
+// Table model for the results of a text search. Only the SearchResult records
+// are kept; the columns are computed when the view asks for them, i.e., the
+// excerpts of the lines are only extracted for rows that are shown.
+class SearchResultsModel : public QAbstractTableModel
+{
+	Q_OBJECT
+
+public:
+	typedef enum {
+		kFileColumn = 0,
+		kLineColumn,
+		kStartColumn,
+		kEndColumn,
+		kTextColumn,
+		kNumColumns
+	} Column;
+
+	SearchResultsModel(QObject *parent = NULL);
+
+	virtual int rowCount(const QModelIndex& parent = QModelIndex()) const;
+	virtual int columnCount(const QModelIndex& parent = QModelIndex()) const;
+	virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const;
+	virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+
+	// appends rows (for results that come in while a search is running)
+	void addResults(const QList<SearchResult>& newResults);
+	const SearchResult& result(int row) const { return results[row]; }
+
+	// the part of a line shown for a match from start to end
+	static QString excerpt(const QString& text, int start, int end);
+
+private:
+	QList<SearchResult> results;
 };
 
 class PDFSearchResult {
@@ -151,22 +200,87 @@ class SearchResults : public QDockWidget, private Ui::SearchResults
 	Q_OBJECT
 	
 public:
-	static void presentResults(const QString& searchText, const QList<SearchResult>& results,
-							   QMainWindow* parent, bool singleFile);
+	static SearchResults *presentResults(const QString& searchText, const QList<SearchResult>& results,
+										 QMainWindow* parent, bool singleFile);
 	
 	SearchResults(QWidget* parent);
 
+	// for results that come in while a search is still running
+	void addResults(const QList<SearchResult>& results);
+	void setSearching(bool isSearching);
+	int resultCount() const { return model->rowCount(); }
+
 protected slots:
 	void focusChanged(QWidget * old, QWidget * now);
 
 private slots:
 	void showSelectedEntry();
-	void showEntry(QTableWidgetItem * item);
+	void showEntry(const QModelIndex& index);
 	void goToSource();
 	void goToSourceAndClose();
 
 private:
+	void updateTitle();
+
+	SearchResultsModel *model;
 	QPalette editorOriginalPalette, editorModifiedPalette;
+	QString searchText;
+	bool searching;
+};
+
+// Table model for the matches of a "find all" search in a PDF, sorted by page
+// and position; pages are searched in parallel, so matches are merged in as
+// they come in.
+class PDFSearchResultsModel : public QAbstractTableModel
+{
+	Q_OBJECT
+
+public:
+	typedef enum {
+		kPageColumn = 0,
+		kTextColumn,
+		kNumColumns
+	} Column;
+
+	PDFSearchResultsModel(QObject *parent = NULL);
+
+	virtual int rowCount(const QModelIndex& parent = QModelIndex()) const;
+	virtual int columnCount(const QModelIndex& parent = QModelIndex()) const;
+	virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const;
+	virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+
+	// adds matches with the text around them; a sorted run of them that goes
+	// between the same rows (e.g., the matches of one page) is inserted at once
+	void addMatches(const QList<PDFTextMatch>& newMatches, const QStringList& newContexts);
+	const PDFTextMatch& match(int row) const { return matches[row]; }
+
+private:
+	QList<PDFTextMatch> matches;
+	QStringList contexts;	// of matches
+};
+
+// Results of a "find all" search in a PDF; matches are added as they are found
+class PDFSearchResults : public QDockWidget, private Ui::SearchResults
+{
+	Q_OBJECT
+
+public:
+	static PDFSearchResults *presentResults(const QString& searchText, PDFDocument *parent);
+
+	PDFSearchResults(PDFDocument *parent, const QString& searchText);
+
+	void addMatches(const QList<PDFTextMatch>& newMatches, const PDFTextLayer *textLayer);
+
+private slots:
+	void showSelectedEntry();
+	void showEntry(const QModelIndex& index);
+
+private:
+	void updateTitle();
+
+	PDFDocument *document;
+	PDFSearchResultsModel *model;
+	QString searchText;
 };
 
 #endif
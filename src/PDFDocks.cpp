@@ -28,6 +28,9 @@
 #include <QTreeWidget>
 #include <QHeaderView>
 #include <QListWidget>
+#include <QScrollBar>
+#include <QTimer>
+#include <QtConcurrentRun>
 #include <QTableWidget>
 
 PDFDock::PDFDock(PDFDocument *doc)
@@ -43,7 +46,15 @@ PDFDock::~PDFDock()
 
 void PDFDock::documentLoaded()
 {
-	if (!isHidden()) {
+	// let the preview show the new document first
+	filled = false;
+	if (!isHidden())
+		QTimer::singleShot(0, this, SLOT(fillIfVisible()));
+}
+
+void PDFDock::fillIfVisible()
+{
+	if (!isHidden() && !filled && document && document->popplerDoc()) {
 		fillInfo();
 		filled = true;
 	}
@@ -62,7 +73,7 @@ void PDFDock::pageChanged(int page)
 void PDFDock::myVisibilityChanged(bool visible)
 {
 	setWindowTitle(getTitle());
-	if (visible && document && !filled) {
+	if (visible && document && document->popplerDoc() && !filled) {
 		fillInfo();
 		filled = true;
 	}
@@ -237,7 +248,11 @@ QSize PDFDockListWidget::sizeHint() const
 PDFFontsDock::PDFFontsDock(PDFDocument *doc)
 	: PDFDock(doc)
 	, scannedFonts(false)
+	, rescanPending(false)
 {
+	fontScanner = new QFutureWatcher< QList<Poppler::FontInfo> >(this);
+	connect(fontScanner, SIGNAL(finished()), this, SLOT(fontsScanned()));
+
 	setObjectName("fonts");
 	setWindowTitle(getTitle());
 	table = new QTableWidget(this);
@@ -277,11 +292,42 @@ void PDFFontsDock::setHorizontalHeaderLabels()
 		table->setHorizontalHeaderLabels(QStringList() << tr("Name") << tr("Type") << tr("Subset") << tr("File"));
 }
 
+static QList<Poppler::FontInfo> scanFonts(const QString& fileName)
+{
+	QList<Poppler::FontInfo> result;
+	Poppler::Document *doc = Poppler::Document::load(fileName);
+	if (doc != NULL) {
+		if (!doc->isLocked())
+			result = doc->fonts();
+		delete doc;
+	}
+	return result;
+}
+
+void PDFFontsDock::fontsScanned()
+{
+	if (rescanPending) {
+		rescanPending = false;
+		fontScanner->setFuture(QtConcurrent::run(scanFonts, document->fileName()));
+		return;
+	}
+	fonts = fontScanner->result();
+	scannedFonts = true;
+	if (filled)
+		fillInfo();
+}
+
 void PDFFontsDock::fillInfo()
 {
 	if (!scannedFonts) {
-		fonts = document->popplerDoc()->fonts();
-		scannedFonts = true;
+		// the table is filled in by fontsScanned()
+		if (fontScanner->isRunning())
+			rescanPending = true;
+		else
+			fontScanner->setFuture(QtConcurrent::run(scanFonts, document->fileName()));
+		table->clearContents();
+		table->setRowCount(0);
+		return;
 	}
 	table->clearContents();
 	table->setRowCount(0);
@@ -305,6 +351,9 @@ void PDFFontsDock::fillInfo()
 void PDFFontsDock::documentLoaded()
 {
 	scannedFonts = false;
+	// a scan still in progress is for the previous version of the file
+	if (fontScanner->isRunning())
+		rescanPending = true;
 	fonts.clear();
 	PDFDock::documentLoaded();
 }
@@ -318,6 +367,147 @@ void PDFFontsDock::documentClosed()
 	PDFDock::documentClosed();
 }
 
+//////////////// THUMBNAILS ////////////////
+
+// size (in pixels) of the longer side of a thumbnail
+const int kThumbnailSize = 128;
+
+PDFThumbnailDock::PDFThumbnailDock(PDFDocument *doc)
+	: PDFDock(doc)
+{
+	setObjectName("thumbnails");
+	setWindowTitle(getTitle());
+	list = new PDFDockListWidget(this);
+	list->setViewMode(QListView::IconMode);
+	list->setFlow(QListView::TopToBottom);
+	list->setWrapping(false);
+	list->setMovement(QListView::Static);
+	list->setResizeMode(QListView::Adjust);
+	list->setUniformItemSizes(true);
+	list->setIconSize(QSize(kThumbnailSize, kThumbnailSize));
+	list->setSelectionMode(QAbstractItemView::SingleSelection);
+	setWidget(list);
+
+	placeholder = QPixmap(kThumbnailSize, kThumbnailSize);
+	placeholder.fill(Qt::transparent);
+
+	connect(list->verticalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(updateThumbnails()));
+	connect(list, SIGNAL(itemSelectionChanged()), this, SLOT(followSelection()));
+	if (document->pdfRenderer() != NULL)
+		connect(document->pdfRenderer(), SIGNAL(tileRendered(const PDFPageTile&, const QImage&)),
+				this, SLOT(tileRendered(const PDFPageTile&, const QImage&)));
+}
+
+PDFThumbnailDock::~PDFThumbnailDock()
+{
+}
+
+void PDFThumbnailDock::fillInfo()
+{
+	list->clear();
+	rowsWithIcons.clear();
+	Poppler::Document *doc = document->popplerDoc();
+	tiles = QVector<PDFPageTile>(doc->numPages());
+	for (int i = 0; i < doc->numPages(); ++i)
+		new QListWidgetItem(QIcon(placeholder), QString::number(i + 1), list);
+	pageChanged(document->widget()->getCurrentPageIndex());
+	// the rows in view are only known once the list has been laid out
+	QTimer::singleShot(0, this, SLOT(updateThumbnails()));
+}
+
+void PDFThumbnailDock::documentClosed()
+{
+	if (document->pdfRenderer() != NULL)
+		document->pdfRenderer()->cancelRequests(PDFRenderer::kThumbnailChannel);
+	list->clear();
+	rowsWithIcons.clear();
+	tiles.clear();
+	PDFDock::documentClosed();
+}
+
+void PDFThumbnailDock::pageChanged(int page)
+{
+	if (page < 0 || page >= list->count())
+		return;
+	list->blockSignals(true);
+	list->setCurrentRow(page);
+	list->blockSignals(false);
+	list->scrollToItem(list->item(page));
+}
+
+void PDFThumbnailDock::followSelection()
+{
+	int row = list->currentRow();
+	if (row >= 0)
+		document->widget()->goToPage(row);
+}
+
+void PDFThumbnailDock::resizeEvent(QResizeEvent *event)
+{
+	PDFDock::resizeEvent(event);
+	updateThumbnails();
+}
+
+PDFPageTile PDFThumbnailDock::thumbnailTile(int index)
+{
+	if (tiles[index].isNull()) {
+		QSizeF size = document->widget()->pageSize(index);
+		if (size.isEmpty())
+			return PDFPageTile();
+		qreal dpi = kThumbnailSize * 72.0 / qMax(size.width(), size.height());
+		tiles[index] = PDFPageTile(document->pdfRenderer()->documentKey(), index, dpi,
+								   QRect(QPoint(0, 0), (size * dpi / 72.0).toSize()));
+	}
+	return tiles[index];
+}
+
+// Shows the cached thumbnails of the rows in view and requests the missing
+// ones. Rows far away from the view go back to the placeholder, so memory use
+// doesn't grow with the number of pages looked at.
+void PDFThumbnailDock::updateThumbnails()
+{
+	PDFRenderer *renderer = document->pdfRenderer();
+	if (renderer == NULL || isHidden() || list->count() == 0 || list->count() != tiles.size())
+		return;
+
+	QListWidgetItem *firstItem = list->itemAt(QPoint(1, 1));
+	int first = (firstItem != NULL ? list->row(firstItem) : 0);
+	int last = first;
+	while (last + 1 < list->count() && list->visualItemRect(list->item(last + 1)).top() < list->viewport()->height())
+		++last;
+
+	int margin = last - first + 1;
+	foreach (int row, rowsWithIcons) {
+		if (row < first - margin || row > last + margin) {
+			list->item(row)->setIcon(QIcon(placeholder));
+			rowsWithIcons.remove(row);
+		}
+	}
+
+	QList<PDFPageTile> missing;
+	for (int row = first; row <= last; ++row) {
+		if (rowsWithIcons.contains(row))
+			continue;
+		PDFPageTile tile = thumbnailTile(row);
+		QImage image;
+		if (PDFRenderCache::instance()->lookup(tile, image, false)) {
+			list->item(row)->setIcon(QIcon(QPixmap::fromImage(image)));
+			rowsWithIcons.insert(row);
+		}
+		else if (!tile.isNull())
+			missing << tile;
+	}
+	renderer->requestTiles(PDFRenderer::kThumbnailChannel, missing);
+}
+
+void PDFThumbnailDock::tileRendered(const PDFPageTile& tile, const QImage& image)
+{
+	if (tile.pageIdx < 0 || tile.pageIdx >= tiles.size() || tiles[tile.pageIdx] != tile)
+		return;
+	list->item(tile.pageIdx)->setIcon(QIcon(QPixmap::fromImage(image)));
+	rowsWithIcons.insert(tile.pageIdx);
+}
+
 //////////////// SCROLL AREA ////////////////
 
 PDFScrollArea::PDFScrollArea(QWidget *parent)
@@ -26,8 +26,13 @@
 #include <QTreeWidget>
 #include <QListWidget>
 #include <QScrollArea>
+#include <QFutureWatcher>
+#include <QVector>
+#include <QSet>
+#include <QPixmap>
 
 #include "poppler-qt4.h"
+#include "PDFRenderer.h"
 
 class PDFDocument;
 class QListWidget;
@@ -58,6 +63,7 @@ protected:
 
 private slots:
 	void myVisibilityChanged(bool visible);
+	void fillIfVisible();
 
 protected slots:
 	virtual void changeLanguage();
@@ -152,10 +158,52 @@ protected:
 protected slots:
 	virtual void changeLanguage();
 
+private slots:
+	void fontsScanned();
+
 private:
 	QTableWidget *table;
 	QList<Poppler::FontInfo> fonts;
 	bool scannedFonts;
+
+	// scanning the fonts means going through all pages, so it is done in
+	// the background using a separate Poppler::Document
+	QFutureWatcher< QList<Poppler::FontInfo> > *fontScanner;
+	bool rescanPending;
+};
+
+
+// Page thumbnails; only the rows in view are rendered (in the background),
+// so documents with thousands of pages remain responsive
+class PDFThumbnailDock : public PDFDock
+{
+	Q_OBJECT
+
+public:
+	PDFThumbnailDock(PDFDocument *doc = 0);
+	~PDFThumbnailDock();
+
+public slots:
+	virtual void documentClosed();
+	virtual void pageChanged(int page);
+
+protected:
+	virtual void fillInfo();
+	virtual QString getTitle() { return tr("Thumbnails"); }
+	virtual void resizeEvent(QResizeEvent *event);
+
+private slots:
+	void updateThumbnails();
+	void tileRendered(const PDFPageTile& tile, const QImage& image);
+	void followSelection();
+
+private:
+	PDFPageTile thumbnailTile(int index);
+
+	QListWidget *list;
+	QVector<PDFPageTile> tiles;	// thumbnail tile of each page, computed as needed
+	QSet<int> rowsWithIcons;	// rows showing a thumbnail (and not the placeholder)
+	QPixmap placeholder;
 };
 
 
@@ -50,6 +50,10 @@
 #include <QFileSystemWatcher>
 #include <QToolTip>
 #include <QSignalMapper>
+#include <QActionGroup>
+#include <QSet>
+#include <QtConcurrentRun>
+#include <QtConcurrentMap>
 
 #include <math.h>
 
@@ -57,8 +61,6 @@
 
 #include "poppler-link.h"
 
-#define SYNCTEX_GZ_EXT	".synctex.gz"
-#define SYNCTEX_EXT		".synctex"
 
 #define ROUND(x) floor((x)+0.5)
 
@@ -77,60 +79,178 @@ const int kSelectImage = 4;
 // duration of highlighting in PDF view (might make configurable?)
 const int kPDFHighlightDuration = 2000;
 
+// placeholders are rendered at a fraction of the view resolution (but never
+// above kMaxPlaceholderDpi) and shown until the sharp tiles arrive
+const qreal kPlaceholderScale = 0.25;
+const qreal kMaxPlaceholderDpi = 72.0;
+
+// gap between pages (in points) in the continuous page modes
+const qreal kPageSpacing = 6.0;
+
 // mask of all modified keys we check against
 const int keyboardModifierMask = Qt::ShiftModifier | Qt::ControlModifier | Qt::AltModifier | Qt::MetaModifier;
 
+// orders tiles by their distance from a given point (e.g. the center of
+// the visible area) so the most relevant ones are rendered first
+class TileDistanceLessThan
+{
+public:
+	TileDistanceLessThan(const QPoint& pt, const QHash<int, QPoint>& offsets)
+		: center(pt), pageOffsets(offsets) { }
+	bool operator()(const PDFPageTile& t1, const PDFPageTile& t2) const
+		{
+			return distance(t1) < distance(t2);
+		}
+private:
+	int distance(const PDFPageTile& t) const
+		{
+			return (t.rect.center() + pageOffsets.value(t.pageIdx) - center).manhattanLength();
+		}
+	QPoint center;
+	QHash<int, QPoint> pageOffsets;	// tile rects are relative to their page
+};
+
+// size (in pixels) of a page (or the whole layout) rendered at renderDpi
+static QSize pixelSize(const QSizeF& sizeInPoints, qreal renderDpi)
+{
+	return (sizeInPoints * renderDpi / 72.0).toSize();
+}
+
+// returns the grid tiles (rendered at renderDpi) of a page of the given size
+// that intersect r; r is relative to the top left corner of the page
+static QList<PDFPageTile> tileGrid(quint64 docKey, int index, qreal renderDpi, const QSize& pageSize, const QRect& r)
+{
+	QList<PDFPageTile> result;
+	QRect pageBounds(QPoint(0, 0), pageSize);
+	QRect bounds = r.intersected(pageBounds);
+	if (bounds.isEmpty())
+		return result;
+	for (int y = bounds.top() / kPDFTileSize; y <= bounds.bottom() / kPDFTileSize; ++y) {
+		for (int x = bounds.left() / kPDFTileSize; x <= bounds.right() / kPDFTileSize; ++x) {
+			QRect tileRect(x * kPDFTileSize, y * kPDFTileSize, kPDFTileSize, kPDFTileSize);
+			result << PDFPageTile(docKey, index, renderDpi, tileRect.intersected(pageBounds));
+		}
+	}
+	return result;
+}
+
 #pragma mark === PDFMagnifier ===
 
 const int kMagFactor = 2;
 
-PDFMagnifier::PDFMagnifier(QWidget *parent, qreal inDpi)
+PDFMagnifier::PDFMagnifier(PDFWidget *parent, qreal inDpi)
 	: QLabel(parent)
-	, page(NULL)
+	, pdfWidget(parent)
 	, scaleFactor(kMagFactor)
 	, parentDpi(inDpi)
-	, imageDpi(0)
-	, imagePage(NULL)
 {
+	if (pdfWidget->renderer != NULL)
+		connect(pdfWidget->renderer, SIGNAL(tileRendered(const PDFPageTile&, const QImage&)),
+				this, SLOT(tileRendered(const PDFPageTile&, const QImage&)));
 }
 
-void PDFMagnifier::setPage(Poppler::Page *p, qreal scale)
+void PDFMagnifier::setScale(qreal scale)
 {
-	page = p;
 	scaleFactor = scale * kMagFactor;
-	if (page == NULL) {
-		imagePage = NULL;
-		image = QImage();
+	requestTiles();
+	update();
+}
+
+// offset of the magnifier's contents in the magnified PDFWidget
+QPoint PDFMagnifier::magnifiedOrigin() const
+{
+	return geometry().center() * kMagFactor - QPoint(width() / 2, height() / 2);
+}
+
+// returns the magnified tiles intersecting r (in magnified PDFWidget
+// coordinates), together with the offsets of the pages they belong to
+QList<PDFPageTile> PDFMagnifier::tilesForRect(const QRect& r, QHash<int, QPoint>& pageOffsets) const
+{
+	QList<PDFPageTile> result;
+	QRect parentRect(r.topLeft() / kMagFactor, r.bottomRight() / kMagFactor);
+	foreach (int index, pdfWidget->pagesInRect(parentRect)) {
+		QRect pr = pdfWidget->pageRect(index);
+		QPoint offset = pr.topLeft() * kMagFactor;
+		pageOffsets.insert(index, offset);
+		result << tileGrid(pdfWidget->docKey, index, parentDpi * scaleFactor, pr.size() * kMagFactor,
+						   r.translated(-offset));
 	}
-	else {
-		PDFWidget* parent = qobject_cast<PDFWidget*>(parentWidget());
-		if (parent != NULL) {
-			QWidget* viewport = parent->parentWidget();
-			if (viewport != NULL) {
-				qreal dpi = parentDpi * scaleFactor;
-				QPoint tl = parent->mapFromParent(viewport->rect().topLeft());
-				QPoint br = parent->mapFromParent(viewport->rect().bottomRight());
-				QSize  size = QSize(br.x() - tl.x(), br.y() - tl.y()) * kMagFactor;
-				QPoint loc = tl * kMagFactor;
-				if (page != imagePage || dpi != imageDpi || loc != imageLoc || size != imageSize)
-					image = page->renderToImage(dpi, dpi, loc.x(), loc.y(), size.width(), size.height());
-				imagePage = page;
-				imageDpi = dpi;
-				imageLoc = loc;
-				imageSize = size;
-			}
-		}
+	return result;
+}
+
+// ask for the tiles under the magnifier and a margin around it, so moving
+// the magnifier usually finds its tiles in the cache already
+void PDFMagnifier::requestTiles()
+{
+	PDFRenderer *renderer = pdfWidget->renderer;
+	if (renderer == NULL || isHidden())
+		return;
+	QHash<int, QPoint> pageOffsets;
+	QRect r(magnifiedOrigin(), size());
+	QList<PDFPageTile> missing;
+	foreach (const PDFPageTile& tile, tilesForRect(r.adjusted(-kPDFTileSize, -kPDFTileSize, kPDFTileSize, kPDFTileSize), pageOffsets)) {
+		if (!PDFRenderCache::instance()->contains(tile))
+			missing << tile;
 	}
-	update();
+	qSort(missing.begin(), missing.end(), TileDistanceLessThan(r.center(), pageOffsets));
+	renderer->requestTiles(PDFRenderer::kMagnifierChannel, missing);
+}
+
+void PDFMagnifier::tileRendered(const PDFPageTile& tile, const QImage& /*image*/)
+{
+	if (tile.docKey == pdfWidget->docKey && tile.dpi == parentDpi * scaleFactor)
+		update();
 }
 
 void PDFMagnifier::paintEvent(QPaintEvent *event)
 {
 	QPainter painter(this);
 	drawFrame(&painter);
-	painter.drawImage(event->rect(), image,
-		event->rect().translated((x() * kMagFactor - imageLoc.x()) + width() / 2,
-								 (y() * kMagFactor - imageLoc.y()) + height() / 2));
+
+	if (pdfWidget->pageMode() != kSinglePage)
+		painter.fillRect(event->rect(), pdfWidget->palette().color(QPalette::Dark));
+
+	PDFRenderCache *cache = PDFRenderCache::instance();
+	QPoint origin = magnifiedOrigin();
+	QHash<int, QPoint> pageOffsets;
+	foreach (const PDFPageTile& tile, tilesForRect(event->rect().translated(origin), pageOffsets)) {
+		QPoint offset = pageOffsets.value(tile.pageIdx) - origin;
+		QRect target = tile.rect.translated(offset);
+		QImage tileImage;
+		if (cache->lookup(tile, tileImage, false)) {
+			painter.drawImage(target.topLeft(), tileImage);
+			continue;
+		}
+
+		// until the magnified tile is there, blow up the tiles of the main view
+		painter.fillRect(target, Qt::white);
+		QRect pr = pdfWidget->pageRect(tile.pageIdx);
+		QRect parentRect(tile.rect.topLeft() / kMagFactor + pr.topLeft(), tile.rect.size() / kMagFactor);
+		painter.save();
+		painter.setClipRect(target);
+		foreach (const PDFPageTile& viewTile, pdfWidget->tilesForRect(tile.pageIdx, parentRect)) {
+			if (cache->lookup(viewTile, tileImage, false))
+				painter.drawImage(QRect(viewTile.rect.topLeft() * kMagFactor + offset, viewTile.rect.size() * kMagFactor),
+								  tileImage);
+		}
+		painter.restore();
+	}
+}
+
+void PDFMagnifier::moveEvent(QMoveEvent * /*event*/)
+{
+	requestTiles();
+}
+
+void PDFMagnifier::showEvent(QShowEvent * /*event*/)
+{
+	requestTiles();
+}
+
+void PDFMagnifier::hideEvent(QHideEvent * /*event*/)
+{
+	if (pdfWidget->renderer != NULL)
+		pdfWidget->renderer->cancelRequests(PDFRenderer::kMagnifierChannel);
 }
 
 void PDFMagnifier::resizeEvent(QResizeEvent * /*event*/)
@@ -143,6 +263,43 @@ void PDFMagnifier::resizeEvent(QResizeEvent * /*event*/)
 	}
 }
 
+#pragma mark === PDFLinkIndex ===
+
+PDFLinkIndex::PDFLinkIndex(Poppler::Page *page)
+	: cells(kGridSize * kGridSize)
+{
+	links = page->links();
+	foreach (Poppler::Link *link, links) {
+		QRectF r = link->linkArea().normalized();
+		int right = gridCoordinate(r.right()), bottom = gridCoordinate(r.bottom());
+		for (int row = gridCoordinate(r.top()); row <= bottom; ++row) {
+			for (int column = gridCoordinate(r.left()); column <= right; ++column)
+				cells[cellIndex(column, row)] << link;
+		}
+	}
+}
+
+PDFLinkIndex::~PDFLinkIndex()
+{
+	qDeleteAll(links);
+}
+
+int PDFLinkIndex::gridCoordinate(qreal pos)
+{
+	return qBound(0, (int)(pos * kGridSize), kGridSize - 1);
+}
+
+Poppler::Link *PDFLinkIndex::linkAt(const QPointF& pos) const
+{
+	if (pos.x() < 0 || pos.x() > 1 || pos.y() < 0 || pos.y() > 1)
+		return NULL;
+	foreach (Poppler::Link *link, cells[cellIndex(gridCoordinate(pos.x()), gridCoordinate(pos.y()))]) {
+		if (link->linkArea().normalized().contains(pos))
+			return link;
+	}
+	return NULL;
+}
+
 #pragma mark === PDFWidget ===
 
 QCursor *PDFWidget::magnifierCursor = NULL;
@@ -159,11 +316,21 @@ PDFWidget::PDFWidget()
 	, scaleFactor(1.0)
 	, dpi(72.0)
 	, scaleOption(kFixedMag)
+	, pageModeOpt(kSinglePage)
+	, renderer(NULL)
+	, docKey(0)
+	, staleDocKey(0)
+	, navigationDirection(1)
+	, loadedPageIndex(0)
 	, magnifier(NULL)
 	, usingTool(kNone)
+	, highlightPage(-1)
 {
 	QSETTINGS_OBJECT(settings);
 	dpi = settings.value("previewResolution", QApplication::desktop()->logicalDpiX()).toInt();
+	int mode = settings.value("pdfPageMode", kDefault_PageMode).toInt();
+	if (mode == kContinuous || mode == kFacingPages)
+		pageModeOpt = (pageModeOption)mode;
 	
 	setBackgroundRole(QPalette::Base);
 	setSizePolicy(QSizePolicy::Ignored, QSizePolicy::Ignored);
@@ -219,13 +386,36 @@ PDFWidget::PDFWidget()
 
 PDFWidget::~PDFWidget()
 {
-	if (page)
-		delete page;
+	qDeleteAll(linkIndexes);
+	qDeleteAll(loadedPages);
 }
 
-void PDFWidget::setDocument(Poppler::Document *doc)
+void PDFWidget::setRenderer(PDFRenderer *r)
 {
+	if (renderer != NULL)
+		disconnect(renderer, SIGNAL(tileRendered(const PDFPageTile&, const QImage&)),
+				   this, SLOT(tileRendered(const PDFPageTile&, const QImage&)));
+	renderer = r;
+	if (renderer != NULL)
+		connect(renderer, SIGNAL(tileRendered(const PDFPageTile&, const QImage&)),
+				this, SLOT(tileRendered(const PDFPageTile&, const QImage&)));
+}
+
+void PDFWidget::setDocument(Poppler::Document *doc, const QVector<QSizeF>& sizes)
+{
+	page = NULL;
+	clickedLink = NULL;
+	qDeleteAll(linkIndexes);
+	linkIndexes.clear();
+	qDeleteAll(loadedPages);
+	loadedPages.clear();
 	document = doc;
+	pageSizes = sizes;
+	// the tiles of the current load are used as stand-ins while the new
+	// document is being rendered
+	staleDocKey = docKey;
+	docKey = (renderer != NULL ? renderer->documentKey() : 0);
+	layoutPages();
 	reloadPage();
 }
 
@@ -244,25 +434,291 @@ void PDFWidget::windowResized()
 	update();
 }
 
+
+// returns the tiles of page index that intersect r (in widget coordinates)
+QList<PDFPageTile> PDFWidget::tilesForRect(int index, const QRect& r) const
+{
+	QRect pr = pageRect(index);
+	if (pr.isNull())
+		return QList<PDFPageTile>();
+	return tileGrid(docKey, index, dpi * scaleFactor, pr.size(), r.translated(-pr.topLeft()));
+}
+
+PDFPageTile PDFWidget::placeholderTile(int index) const
+{
+	QSizeF pageSize;
+	if (pageModeOpt == kSinglePage) {
+		if (page == NULL || index != pageIndex)
+			return PDFPageTile();
+		pageSize = page->pageSizeF();
+	}
+	else {
+		if (index < 0 || index >= pageLayout.size())
+			return PDFPageTile();
+		pageSize = pageLayout[index].size();
+	}
+	qreal placeholderDpi = qMin(dpi * scaleFactor * kPlaceholderScale, kMaxPlaceholderDpi);
+	return PDFPageTile(docKey, index, placeholderDpi, QRect(QPoint(0, 0), pixelSize(pageSize, placeholderDpi)));
+}
+
+void PDFWidget::layoutPages()
+{
+	pageLayout.clear();
+	layoutSize = QSizeF();
+	if (document == NULL || pageModeOpt == kSinglePage)
+		return;
+
+	// the page sizes were found when the document was loaded
+	int numPages = pageSizes.size();
+	const QVector<QSizeF>& sizes = pageSizes;
+	qreal leftWidth = 0, rightWidth = 0;
+	for (int i = 0; i < numPages; ++i) {
+		if (pageModeOpt == kFacingPages && i % 2 == 1)
+			rightWidth = qMax(rightWidth, sizes[i].width());
+		else
+			leftWidth = qMax(leftWidth, sizes[i].width());
+	}
+
+	pageLayout.resize(numPages);
+	qreal y = kPageSpacing;
+	if (pageModeOpt == kContinuous) {
+		for (int i = 0; i < numPages; ++i) {
+			pageLayout[i] = QRectF(QPointF(kPageSpacing + (leftWidth - sizes[i].width()) / 2, y), sizes[i]);
+			y += sizes[i].height() + kPageSpacing;
+		}
+		layoutSize = QSizeF(leftWidth + 2 * kPageSpacing, y);
+	}
+	else {
+		for (int i = 0; i < numPages; i += 2) {
+			qreal rowHeight = sizes[i].height();
+			pageLayout[i] = QRectF(QPointF(kPageSpacing + leftWidth - sizes[i].width(), y), sizes[i]);
+			if (i + 1 < numPages) {
+				pageLayout[i + 1] = QRectF(QPointF(2 * kPageSpacing + leftWidth, y), sizes[i + 1]);
+				rowHeight = qMax(rowHeight, sizes[i + 1].height());
+			}
+			y += rowHeight + kPageSpacing;
+		}
+		layoutSize = QSizeF(leftWidth + rightWidth + 3 * kPageSpacing, y);
+	}
+}
+
+// returns the rect of page index in widget coordinates, or a null rect if
+// that page is not displayed
+QRect PDFWidget::pageRect(int index) const
+{
+	if (pageModeOpt == kSinglePage)
+		return (page != NULL && index == pageIndex) ? rect() : QRect();
+	if (index < 0 || index >= pageLayout.size())
+		return QRect();
+	qreal renderDpi = dpi * scaleFactor;
+	const QRectF& r = pageLayout[index];
+	return QRect(QPoint(qRound(r.left() * renderDpi / 72.0), qRound(r.top() * renderDpi / 72.0)),
+				 pixelSize(r.size(), renderDpi));
+}
+
+QList<int> PDFWidget::pagesInRect(const QRect& r) const
+{
+	QList<int> result;
+	if (pageModeOpt == kSinglePage) {
+		if (page != NULL && rect().intersects(r))
+			result << pageIndex;
+		return result;
+	}
+
+	// pages are laid out from top to bottom, so find the first candidate
+	// by bisection (its predecessors may still reach into r, though)
+	int lo = 0, hi = pageLayout.size();
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		if (pageRect(mid).top() <= r.top())
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	int first = qMax(0, lo - (pageModeOpt == kFacingPages ? 2 : 1));
+	while (first > 0 && pageRect(first - 1).bottom() >= r.top())
+		--first;
+
+	for (int i = first; i < pageLayout.size(); ++i) {
+		QRect pr = pageRect(i);
+		if (pr.top() > r.bottom())
+			break;
+		if (pr.intersects(r))
+			result << i;
+	}
+	return result;
+}
+
+// returns the index of the page at pos (or -1) and sets pagePos to the
+// corresponding position on the page (in points)
+int PDFWidget::mapToPage(const QPoint& pos, QPointF& pagePos) const
+{
+	foreach (int index, pagesInRect(QRect(pos, QSize(1, 1)))) {
+		QPoint offset = pos - pageRect(index).topLeft();
+		pagePos = QPointF(offset.x() / scaleFactor * 72.0 / dpi, offset.y() / scaleFactor * 72.0 / dpi);
+		return index;
+	}
+	return -1;
+}
+
+Poppler::Page *PDFWidget::popplerPage(int index)
+{
+	if (document == NULL || index < 0 || index >= document->numPages())
+		return NULL;
+	Poppler::Page *p = loadedPages.value(index, NULL);
+	if (p == NULL) {
+		p = document->page(index);
+		if (p != NULL)
+			loadedPages.insert(index, p);
+	}
+	return p;
+}
+
+// free the Poppler::Page objects of pages far away from the visible area
+void PDFWidget::releaseInvisiblePages()
+{
+	QSet<int> keep;
+	keep << pageIndex;
+	if (pageModeOpt != kSinglePage) {
+		QRect r = visibleRegion().boundingRect();
+		foreach (int index, pagesInRect(r.adjusted(0, -r.height(), 0, r.height())))
+			keep << index;
+	}
+	QMutableHashIterator<int, PDFLinkIndex*> li(linkIndexes);
+	while (li.hasNext()) {
+		li.next();
+		if (!keep.contains(li.key())) {
+			if (li.value()->contains(clickedLink))
+				clickedLink = NULL;
+			delete li.value();
+			li.remove();
+		}
+	}
+	QMutableHashIterator<int, Poppler::Page*> it(loadedPages);
+	while (it.hasNext()) {
+		it.next();
+		if (!keep.contains(it.key())) {
+			delete it.value();
+			it.remove();
+		}
+	}
+}
+
+Poppler::Link *PDFWidget::linkAt(const QPoint& pos, QRectF *area)
+{
+	QPointF pagePos;
+	int index = mapToPage(pos, pagePos);
+	Poppler::Page *p = popplerPage(index);
+	if (p == NULL)
+		return NULL;
+
+	PDFLinkIndex *links = linkIndexes.value(index, NULL);
+	if (links == NULL) {
+		links = new PDFLinkIndex(p);
+		linkIndexes.insert(index, links);
+	}
+
+	// poppler's linkArea is relative to the page rect
+	QPointF scaledPos(pagePos.x() / p->pageSizeF().width(), pagePos.y() / p->pageSizeF().height());
+	Poppler::Link *link = links->linkAt(scaledPos);
+	if (link != NULL && area != NULL) {
+		QRect pr = pageRect(index);
+		QRectF r = link->linkArea().normalized();
+		*area = QRectF(pr.left() + r.left() * pr.width(), pr.top() + r.top() * pr.height(),
+					   r.width() * pr.width(), r.height() * pr.height());
+	}
+	return link;
+}
+
 void PDFWidget::paintEvent(QPaintEvent *event)
 {
 	QPainter painter(this);
 	drawFrame(&painter);
 
-	qreal newDpi = dpi * scaleFactor;
-	QRect newRect = rect();
-	if (page != imagePage || newDpi != imageDpi || newRect != imageRect)
-		if (page != NULL)
-			image = page->renderToImage(dpi * scaleFactor, dpi * scaleFactor,
-						rect().x(), rect().y(), rect().width(), rect().height());
-	imagePage = page;
-	imageDpi = newDpi;
-	imageRect = newRect;
+	if (pageModeOpt != kSinglePage)
+		painter.fillRect(event->rect(), palette().color(QPalette::Dark));
+
+	if (renderer != NULL) {
+		PDFRenderCache *cache = PDFRenderCache::instance();
+
+		foreach (int index, pagesInRect(event->rect())) {
+			QRect pr = pageRect(index);
+			QImage pagePlaceholder;
+			if (!cache->lookup(placeholderTile(index), pagePlaceholder, false) && placeholderKey.pageIdx == index)
+				pagePlaceholder = placeholder;
+
+			foreach (const PDFPageTile& tile, tilesForRect(index, event->rect())) {
+				QRect target = tile.rect.translated(pr.topLeft());
+				QImage tileImage;
+				PDFPageTile staleTile(tile);
+				staleTile.docKey = staleDocKey;
+				if (cache->lookup(tile, tileImage) || cache->lookup(staleTile, tileImage, false))
+					painter.drawImage(target.topLeft(), tileImage);
+				else if (!pagePlaceholder.isNull()) {
+					qreal sx = (qreal)pagePlaceholder.width() / pr.width();
+					qreal sy = (qreal)pagePlaceholder.height() / pr.height();
+					painter.drawImage(QRectF(target), pagePlaceholder,
+									  QRectF(tile.rect.x() * sx, tile.rect.y() * sy,
+											 tile.rect.width() * sx, tile.rect.height() * sy));
+				}
+				else
+					painter.fillRect(target, Qt::white);
+			}
+		}
 
-	painter.drawImage(event->rect(), image, event->rect());
+		// (re)issue the render requests for the visible part of the pages;
+		// this also drops pending requests for tiles that went out of view
+		QRect visibleRect = visibleRegion().boundingRect();
+		QList<PDFPageTile> missing, placeholders;
+		QHash<int, QPoint> pageOffsets;
+		foreach (int index, pagesInRect(visibleRect)) {
+			bool pageComplete = true;
+			foreach (const PDFPageTile& tile, tilesForRect(index, visibleRect)) {
+				if (!cache->contains(tile)) {
+					missing << tile;
+					pageComplete = false;
+				}
+			}
+			if (!pageComplete && !cache->contains(placeholderTile(index)))
+				placeholders << placeholderTile(index);
+			pageOffsets.insert(index, pageRect(index).topLeft());
+		}
+		qSort(missing.begin(), missing.end(), TileDistanceLessThan(visibleRect.center(), pageOffsets));
+		if (missing.isEmpty())
+			prefetchPages();
+		else if (!prefetchKey.isNull()) {
+			// the view comes first; start over once it is complete
+			renderer->cancelRequests(PDFRenderer::kPrefetchChannel);
+			prefetchKey = PDFPageTile();
+		}
+		renderer->requestTiles(PDFRenderer::kPlaceholderChannel, placeholders);
+		renderer->requestTiles(PDFRenderer::kViewChannel, missing);
+	}
+
+	// boxes from overlapping source lines add up, so the shading is darkest
+	// where the most lines went
+	if (!sourceOverlay.isEmpty()) {
+		painter.save();
+		painter.setPen(Qt::NoPen);
+		painter.setBrush(QColor(0, 127, 255, 31));
+		foreach (int index, pagesInRect(event->rect())) {
+			QMap<int, QList<QRectF> >::const_iterator rects = sourceOverlay.constFind(index);
+			if (rects == sourceOverlay.constEnd())
+				continue;
+			painter.save();
+			painter.translate(pageRect(index).topLeft());
+			painter.scale(dpi / 72.0 * scaleFactor, dpi / 72.0 * scaleFactor);
+			foreach (const QRectF& rect, rects.value())
+				painter.drawRect(rect);
+			painter.restore();
+		}
+		painter.restore();
+	}
 
-	if (!highlightPath.isEmpty()) {
+	QRect highlightRect = pageRect(highlightPage);
+	if (!highlightPath.isEmpty() && !highlightRect.isNull()) {
 		painter.setRenderHint(QPainter::Antialiasing);
+		painter.translate(highlightRect.topLeft());
 		painter.scale(dpi / 72.0 * scaleFactor, dpi / 72.0 * scaleFactor);
 		painter.setPen(QColor(0, 0, 0, 0));
 		painter.setBrush(QColor(255, 255, 0, 63));
@@ -270,6 +726,66 @@ void PDFWidget::paintEvent(QPaintEvent *event)
 	}
 }
 
+QList<PDFPageTile> PDFWidget::pageTiles(int index, qreal renderDpi) const
+{
+	QList<PDFPageTile> result;
+	if (document == NULL || index < 0 || index >= pageSizes.size())
+		return result;
+	QRect pageRect(QPoint(0, 0), pixelSize(pageSizes[index], renderDpi));
+	for (int y = 0; y < pageRect.height(); y += kPDFTileSize) {
+		for (int x = 0; x < pageRect.width(); x += kPDFTileSize)
+			result << PDFPageTile(docKey, index, renderDpi,
+								  QRect(x, y, kPDFTileSize, kPDFTileSize).intersected(pageRect));
+	}
+	return result;
+}
+
+// Once the visible part of the current page is complete, render the pages
+// around it at the current resolution into the cache; pages in the direction
+// we have been moving come first.
+void PDFWidget::prefetchPages()
+{
+	qreal renderDpi = dpi * scaleFactor;
+	PDFPageTile key(docKey, pageIndex, renderDpi);
+	if (renderer == NULL || document == NULL || key == prefetchKey)
+		return;
+	prefetchKey = key;
+
+	QSETTINGS_OBJECT(settings);
+	int numPages = settings.value("pdfPrefetchPages", kDefault_PrefetchPages).toInt();
+	QList<int> pages;
+	for (int i = 1; i <= numPages; ++i)
+		pages << pageIndex + i * navigationDirection;
+	for (int i = 1; i <= numPages; ++i)
+		pages << pageIndex - i * navigationDirection;
+
+	PDFRenderCache *cache = PDFRenderCache::instance();
+	QList<PDFPageTile> requests;
+	foreach (int index, pages) {
+		foreach (const PDFPageTile& tile, pageTiles(index, renderDpi)) {
+			if (!cache->contains(tile))
+				requests << tile;
+		}
+	}
+	renderer->requestTiles(PDFRenderer::kPrefetchChannel, requests);
+}
+
+void PDFWidget::tileRendered(const PDFPageTile& tile, const QImage& tileImage)
+{
+	QRect pr = pageRect(tile.pageIdx);
+	if (tile.docKey != docKey || pr.isNull())
+		return;
+	if (tile == placeholderTile(tile.pageIdx)) {
+		if (tile.pageIdx == pageIndex) {
+			placeholder = tileImage;
+			placeholderKey = tile;
+		}
+		update(pr);
+	}
+	else if (tile.dpi == dpi * scaleFactor)
+		update(tile.rect.translated(pr.topLeft()));
+}
+
 void PDFWidget::useMagnifier(const QMouseEvent *inEvent)
 {
 	if (!magnifier) {
@@ -281,7 +797,7 @@ void PDFWidget::useMagnifier(const QMouseEvent *inEvent)
 		magnifierSize = magSizes[magnifierSize - 1];
 		magnifier->setFixedSize(magnifierSize * 4 / 3, magnifierSize);
 	}
-	magnifier->setPage(page, scaleFactor);
+	magnifier->setScale(scaleFactor);
 	// this was in the hope that if the mouse is released before the image is ready,
 	// the magnifier wouldn't actually get shown. but it doesn't seem to work that way -
 	// the MouseMove event that we're posting must end up ahead of the mouseUp
@@ -344,18 +860,11 @@ void PDFWidget::mousePressEvent(QMouseEvent *event)
 	}
 	
 	// Context-specific behavior comes second
-	if (!handled && page) {
-		foreach (Poppler::Link* link, page->links()) {
-			// poppler's linkArea is relative to the page rect, it seems
-			QPointF scaledPos(event->pos().x() / scaleFactor / dpi * 72.0 / page->pageSizeF().width(),
-								event->pos().y() / scaleFactor / dpi * 72.0 / page->pageSizeF().height());
-			if (link->linkArea().contains(scaledPos)) {
-				clickedLink = link;
-				// opening the link is handled in mouseReleaseEvent
-				handled = true;
-				break;
-			}
-		}
+	if (!handled) {
+		clickedLink = linkAt(event->pos());
+		// opening the link is handled in mouseReleaseEvent
+		if (clickedLink != NULL)
+			handled = true;
 	}
 	
 	// Default behavior has the lowest priority
@@ -396,9 +905,10 @@ void PDFWidget::mouseReleaseEvent(QMouseEvent *event)
 			if((mods & keyboardModifierMask) == Qt::ControlModifier) {
 				// Ctrl-click to sync
 				if ((mouseDownModifiers & keyboardModifierMask) == Qt::ControlModifier) {
-					QPointF pagePos(event->pos().x() / scaleFactor * 72.0 / dpi,
-									event->pos().y() / scaleFactor * 72.0 / dpi);
-					emit syncClick(pageIndex, pagePos);
+					QPointF pagePos;
+					int index = mapToPage(event->pos(), pagePos);
+					if (index >= 0)
+						emit syncClick(index, pagePos);
 				}
 				break;
 			}
@@ -417,9 +927,7 @@ void PDFWidget::mouseReleaseEvent(QMouseEvent *event)
 
 			// Context-specific behavior comes second
 			if (clickedLink != NULL) {
-				QPointF scaledPos(event->pos().x() / scaleFactor / dpi * 72.0 / page->pageSizeF().width(),
-									event->pos().y() / scaleFactor / dpi * 72.0 / page->pageSizeF().height());
-				if (clickedLink->linkArea().contains(scaledPos)) {
+				if (linkAt(event->pos()) == clickedLink) {
 					doLink(clickedLink);
 					break;
 				}
@@ -442,13 +950,14 @@ void PDFWidget::goToDestination(const Poppler::LinkDestination& dest)
 			// FIXME
 		}
 		QScrollArea*	scrollArea = getScrollArea();
-		if (scrollArea) {
+		QRect pr = pageRect(dest.pageNumber() - 1);
+		if (scrollArea && !pr.isNull()) {
 			if (dest.isChangeLeft()) {
-				int destLeft = (int)floor(dest.left() * scaleFactor * dpi / 72.0 * page->pageSizeF().width());
+				int destLeft = pr.left() + (int)floor(dest.left() * pr.width());
 				scrollArea->horizontalScrollBar()->setValue(destLeft);
 			}
 			if (dest.isChangeTop()) {
-				int destTop = (int)floor(dest.top() * scaleFactor * dpi / 72.0 * page->pageSizeF().height());
+				int destTop = pr.top() + (int)floor(dest.top() * pr.height());
 				scrollArea->verticalScrollBar()->setValue(destTop);
 			}
 		}
@@ -618,17 +1127,18 @@ void PDFWidget::jumpToSource()
 {
 	QAction *act = qobject_cast<QAction*>(sender());
 	if (act != NULL) {
-		QPoint eventPos = act->data().toPoint();
-		QPointF pagePos(eventPos.x() / scaleFactor * 72.0 / dpi,
-						eventPos.y() / scaleFactor * 72.0 / dpi);
-		emit syncClick(pageIndex, pagePos);
+		QPointF pagePos;
+		int index = mapToPage(act->data().toPoint(), pagePos);
+		if (index >= 0)
+			emit syncClick(index, pagePos);
 	}
 }
 
 void PDFWidget::wheelEvent(QWheelEvent *event)
 {
 	static QTime lastScrollTime = QTime::currentTime();
-	bool mayChangePage = true;
+	// in the continuous modes, scrolling moves through the pages anyway
+	bool mayChangePage = (pageModeOpt == kSinglePage);
 	int numDegrees = event->delta() / 8;
 	int numSteps = numDegrees / 15;
 	QScrollBar *scrollBar = (event->orientation() == Qt::Horizontal)
@@ -695,30 +1205,19 @@ void PDFWidget::updateCursor(const QPoint& pos)
 	}
 	
 	// Context-specific behavior comes second
-	if(page) {
-		// check for link
-		foreach (Poppler::Link* link, page->links()) {
-			// poppler's linkArea is relative to the page rect
-			QPointF scaledPos(pos.x() / scaleFactor / dpi * 72.0 / page->pageSizeF().width(),
-								pos.y() / scaleFactor / dpi * 72.0 / page->pageSizeF().height());
-			if (link->linkArea().contains(scaledPos)) {
-				setCursor(Qt::PointingHandCursor);
-				if (link->linkType() == Poppler::Link::Browse) {
-					QPoint globalPos = mapToGlobal(pos);
-					const Poppler::LinkBrowse *browse = dynamic_cast<const Poppler::LinkBrowse*>(link);
-					Q_ASSERT(browse != NULL);
-					QRectF r = link->linkArea();
-					r.setWidth(r.width() * scaleFactor * dpi / 72.0 * page->pageSizeF().width());
-					r.setHeight(r.height() * scaleFactor * dpi / 72.0 * page->pageSizeF().height());
-					r.moveLeft(r.left() * scaleFactor * dpi / 72.0 * page->pageSizeF().width());
-					r.moveTop(r.top() * scaleFactor * dpi / 72.0 * page->pageSizeF().height());
-					QRect rr = r.toRect().normalized();
-					rr.setTopLeft(mapToGlobal(rr.topLeft()));
-					QToolTip::showText(globalPos, browse->url(), this, rr);
-				}
-				return;
-			}
+	QRectF linkArea;
+	Poppler::Link *link = linkAt(pos, &linkArea);
+	if (link != NULL) {
+		setCursor(Qt::PointingHandCursor);
+		if (link->linkType() == Poppler::Link::Browse) {
+			QPoint globalPos = mapToGlobal(pos);
+			const Poppler::LinkBrowse *browse = dynamic_cast<const Poppler::LinkBrowse*>(link);
+			Q_ASSERT(browse != NULL);
+			QRect rr = linkArea.toRect().normalized();
+			rr.setTopLeft(mapToGlobal(rr.topLeft()));
+			QToolTip::showText(globalPos, browse->url(), this, rr);
 		}
+		return;
 	}
 
 	// Default behavior has the lowest priority
@@ -743,11 +1242,13 @@ void PDFWidget::updateCursor(const QPoint& pos)
 
 void PDFWidget::adjustSize()
 {
-	if (page) {
-		QSize	pageSize = (page->pageSizeF() * scaleFactor * dpi / 72.0).toSize();
-		if (pageSize != size())
-			resize(pageSize);
-	}
+	QSize newSize;
+	if (pageModeOpt != kSinglePage)
+		newSize = pixelSize(layoutSize, dpi * scaleFactor);
+	else if (page)
+		newSize = pixelSize(page->pageSizeF(), dpi * scaleFactor);
+	if (!newSize.isEmpty() && newSize != size())
+		resize(newSize);
 }
 
 void PDFWidget::resetMagnifier()
@@ -769,18 +1270,26 @@ void PDFWidget::setHighlightPath(const QPainterPath& path)
 {
 	highlightRemover.stop();
 	highlightPath = path;
+	highlightPage = pageIndex;
 	if (!path.isEmpty()) {
 		QScrollArea*	scrollArea = getScrollArea();
 		if (scrollArea) {
 			QRectF r = path.boundingRect();
-			scrollArea->ensureVisible((int)((r.left() + r.right()) / 2 * dpi / 72 * scaleFactor),
-										(int)((r.top() + r.bottom()) / 2 * dpi / 72 * scaleFactor));
+			QPoint offset = pageRect(highlightPage).topLeft();
+			scrollArea->ensureVisible(offset.x() + (int)((r.left() + r.right()) / 2 * dpi / 72 * scaleFactor),
+										offset.y() + (int)((r.top() + r.bottom()) / 2 * dpi / 72 * scaleFactor));
 		}
 		if (kPDFHighlightDuration > 0)
 			highlightRemover.start(kPDFHighlightDuration);
 	}
 }
 
+void PDFWidget::setSourceOverlay(const QMap<int, QList<QRectF> >& rects)
+{
+	sourceOverlay = rects;
+	update();
+}
+
 void PDFWidget::clearHighlight()
 {
 	highlightPath = QPainterPath();
@@ -789,21 +1298,19 @@ void PDFWidget::clearHighlight()
 
 void PDFWidget::reloadPage()
 {
-	if (page != NULL)
-		delete page;
+	if (pageIndex != loadedPageIndex)
+		navigationDirection = (pageIndex < loadedPageIndex ? -1 : 1);
 	page = NULL;
-	if (magnifier != NULL)
-		magnifier->setPage(NULL, 0);
-	imagePage = NULL;
-	image = QImage();
 	highlightPath = QPainterPath();
 	if (document != NULL) {
 		if (pageIndex >= document->numPages())
 			pageIndex = document->numPages() - 1;
 		if (pageIndex >= 0)
-			page = document->page(pageIndex);
+			page = popplerPage(pageIndex);
 	}
+	loadedPageIndex = pageIndex;
 	adjustSize();
+	releaseInvisiblePages();
 	update();
 	updateStatusBar();
 	emit changedPage(pageIndex);
@@ -821,38 +1328,26 @@ void PDFWidget::updateStatusBar()
 
 void PDFWidget::goFirst()
 {
-	if (pageIndex != 0) {
-		pageIndex = 0;
-		reloadPage();
-		update();
-	}
+	if (pageIndex != 0)
+		goToPage(0);
 }
 
 void PDFWidget::goPrev()
 {
-	if (pageIndex > 0) {
-		--pageIndex;
-		reloadPage();
-		update();
-	}
+	if (pageIndex > 0)
+		goToPage(pageIndex - 1);
 }
 
 void PDFWidget::goNext()
 {
-	if (document != NULL && pageIndex < document->numPages() - 1) {
-		++pageIndex;
-		reloadPage();
-		update();
-	}
+	if (document != NULL && pageIndex < document->numPages() - 1)
+		goToPage(pageIndex + 1);
 }
 
 void PDFWidget::goLast()
 {
-	if (document != NULL && pageIndex != document->numPages() - 1) {
-		pageIndex = document->numPages() - 1;
-		reloadPage();
-		update();
-	}
+	if (document != NULL && pageIndex != document->numPages() - 1)
+		goToPage(document->numPages() - 1);
 }
 
 void PDFWidget::upOrPrev()
@@ -934,15 +1429,74 @@ void PDFWidget::doPageDialog()
 
 void PDFWidget::goToPage(int p)
 {
+	if (document == NULL && p >= 0) {
+		// the document is still being loaded; show the page once it's there
+		pageIndex = p;
+		return;
+	}
 	if (p != pageIndex && document != NULL) {
 		if (p >= 0 && p < document->numPages()) {
 			pageIndex = p;
 			reloadPage();
+			scrollToPage(p);
 			update();
 		}
 	}
 }
 
+void PDFWidget::scrollToPage(int index)
+{
+	if (pageModeOpt == kSinglePage)
+		return;
+	QScrollArea*	scrollArea = getScrollArea();
+	QRect pr = pageRect(index);
+	if (scrollArea && !pr.isNull())
+		scrollArea->verticalScrollBar()->setValue(pr.top() - (int)(kPageSpacing * dpi / 72.0 * scaleFactor));
+}
+
+// called when the view is scrolled; in the continuous modes, the page
+// taking up most of the visible area becomes the current one
+void PDFWidget::scrolled()
+{
+	if (pageModeOpt == kSinglePage || document == NULL)
+		return;
+	QRect visibleRect = visibleRegion().boundingRect();
+	int newIndex = -1, maxArea = 0;
+	foreach (int index, pagesInRect(visibleRect)) {
+		QRect r = pageRect(index).intersected(visibleRect);
+		if (r.width() * r.height() > maxArea) {
+			maxArea = r.width() * r.height();
+			newIndex = index;
+		}
+	}
+	if (newIndex >= 0 && newIndex != pageIndex) {
+		pageIndex = newIndex;
+		navigationDirection = (pageIndex < loadedPageIndex ? -1 : 1);
+		loadedPageIndex = pageIndex;
+		page = popplerPage(pageIndex);
+		updateStatusBar();
+		emit changedPage(pageIndex);
+	}
+	releaseInvisiblePages();
+}
+
+void PDFWidget::setPageMode(int mode)
+{
+	if (mode != kSinglePage && mode != kContinuous && mode != kFacingPages)
+		return;
+	if (mode != pageModeOpt) {
+		pageModeOpt = (pageModeOption)mode;
+		QSETTINGS_OBJECT(settings);
+		settings.setValue("pdfPageMode", mode);
+		layoutPages();
+		adjustSize();
+		scrollToPage(pageIndex);
+		releaseInvisiblePages();
+		update();
+	}
+	emit changedPageMode(pageModeOpt);
+}
+
 void PDFWidget::fixedScale(qreal scale)
 {
 	scaleOption = kFixedMag;
@@ -963,7 +1517,7 @@ void PDFWidget::fitWidth(bool checked)
 		QScrollArea*	scrollArea = getScrollArea();
 		if (scrollArea && page != NULL) {
 			qreal portWidth = scrollArea->viewport()->width();
-			QSizeF	pageSize = page->pageSizeF() * dpi / 72.0;
+			QSizeF	pageSize = (pageModeOpt == kSinglePage ? page->pageSizeF() : layoutSize) * dpi / 72.0;
 			scaleFactor = portWidth / pageSize.width();
 			if (scaleFactor < kMinScaleFactor)
 				scaleFactor = kMinScaleFactor;
@@ -988,7 +1542,10 @@ void PDFWidget::fitWindow(bool checked)
 		if (scrollArea && page != NULL) {
 			qreal portWidth = scrollArea->viewport()->width();
 			qreal portHeight = scrollArea->viewport()->height();
-			QSizeF	pageSize = page->pageSizeF() * dpi / 72.0;
+			QSizeF	pageSize = page->pageSizeF();
+			if (pageModeOpt != kSinglePage)
+				pageSize.setWidth(layoutSize.width());
+			pageSize *= dpi / 72.0;
 			qreal sfh = portWidth / pageSize.width();
 			qreal sfv = portHeight / pageSize.height();
 			scaleFactor = sfh < sfv ? sfh : sfv;
@@ -1103,7 +1660,14 @@ QScrollArea* PDFWidget::getScrollArea()
 QList<PDFDocument*> PDFDocument::docList;
 
 PDFDocument::PDFDocument(const QString &fileName, TeXDocument *texDoc)
-	: watcher(NULL), reloadTimer(NULL), scanner(NULL), openedManually(false)
+	: previousDocKey(0), watcher(NULL), reloadTimer(NULL)
+	, loadingDocument(false), documentReloadPending(false)
+	, loadingSyncData(false), syncReloadPending(false), loadingSyncPages(false)
+	, runningSyncQuery(false), syncQueryActivate(false), runningOverlayQuery(false), overlayQueryPending(false)
+	, visibleFirstLine(-1), visibleLastLine(-1)
+	, pendingSyncLine(-1), pendingSyncActivate(false), pendingClickPage(-1)
+	, findAllCaseSensitivity(Qt::CaseInsensitive), findAllSearcher(NULL)
+	, openedManually(false)
 {
 	init();
 
@@ -1134,8 +1698,17 @@ PDFDocument::PDFDocument(const QString &fileName, TeXDocument *texDoc)
 
 PDFDocument::~PDFDocument()
 {
-	if (scanner != NULL)
-		synctex_scanner_free(scanner);
+	PDFRenderCache::instance()->invalidate(previousDocKey);
+	PDFRenderCache::instance()->invalidate(renderer->documentKey());
+	// the render thread may be busy with a page; it finishes that on its own
+	// and is deleted then
+	if (renderer->isRunning()) {
+		renderer->setParent(NULL);
+		connect(renderer, SIGNAL(finished()), renderer, SLOT(deleteLater()));
+		renderer->stop();
+	}
+	// background loads and queries are left to finish, too; their results
+	// go away with the watchers
 	docList.removeAll(this);
 	if (document)
 		delete document;
@@ -1165,7 +1738,10 @@ PDFDocument::init()
 	
 	setContextMenuPolicy(Qt::NoContextMenu);
 
+	renderer = new PDFRenderer(this);
+
 	pdfWidget = new PDFWidget;
+	pdfWidget->setRenderer(renderer);
 
 	toolButtonGroup = new QButtonGroup(toolBar);
 	toolButtonGroup->addButton(qobject_cast<QAbstractButton*>(toolBar->widgetForAction(actionMagnify)), kMagnifier);
@@ -1194,8 +1770,26 @@ PDFDocument::init()
 	setCentralWidget(scrollArea);
 	
 	connect(scrollArea, SIGNAL(resized()), pdfWidget, SLOT(windowResized()));
+	connect(scrollArea->verticalScrollBar(), SIGNAL(valueChanged(int)), pdfWidget, SLOT(scrolled()));
+	connect(scrollArea->horizontalScrollBar(), SIGNAL(valueChanged(int)), pdfWidget, SLOT(scrolled()));
 
 	document = NULL;
+
+	documentLoader = new QFutureWatcher<PDFLoadedDocumentPointer>(this);
+	connect(documentLoader, SIGNAL(finished()), this, SLOT(documentLoadFinished()));
+	syncLoader = new QFutureWatcher<SyncTeXIndexPointer>(this);
+	connect(syncLoader, SIGNAL(finished()), this, SLOT(syncDataLoadFinished()));
+	syncPageLoader = new QFutureWatcher<void>(this);
+	connect(syncPageLoader, SIGNAL(finished()), this, SLOT(syncPagesLoaded()));
+	syncQuery = new QFutureWatcher<PDFSyncResult>(this);
+	connect(syncQuery, SIGNAL(finished()), this, SLOT(syncQueryFinished()));
+	overlayQuery = new QFutureWatcher< QMap<int, QList<QRectF> > >(this);
+	connect(overlayQuery, SIGNAL(finished()), this, SLOT(overlayQueryFinished()));
+
+	textLayer = new PDFTextLayer(this);
+	connect(renderer, SIGNAL(pagesUnchanged(quint64, quint64, const PDFPageMapping&)),
+			textLayer, SLOT(reusePages(quint64, quint64, const PDFPageMapping&)));
+	connect(textLayer, SIGNAL(pageExtracted(int)), this, SLOT(findAllPageExtracted(int)));
 	
 	connect(actionAbout_TW, SIGNAL(triggered()), qApp, SLOT(about()));
 	connect(actionSettings_and_Resources, SIGNAL(triggered()), qApp, SLOT(doResourcesDialog()));
@@ -1224,8 +1818,24 @@ PDFDocument::init()
 	connect(actionZoom_In, SIGNAL(triggered()), pdfWidget, SLOT(zoomIn()));
 	connect(actionZoom_Out, SIGNAL(triggered()), pdfWidget, SLOT(zoomOut()));
 	connect(actionFull_Screen, SIGNAL(triggered()), this, SLOT(toggleFullScreen()));
+	connect(actionShow_Visible_Source, SIGNAL(toggled(bool)), this, SLOT(updateSourceOverlay()));
 	connect(pdfWidget, SIGNAL(changedZoom(qreal)), this, SLOT(enableZoomActions(qreal)));
 	connect(pdfWidget, SIGNAL(changedScaleOption(autoScaleOption)), this, SLOT(adjustScaleActions(autoScaleOption)));
+
+	QActionGroup *pageModeGroup = new QActionGroup(this);
+	QSignalMapper *pageModeMapper = new QSignalMapper(this);
+	pageModeGroup->addAction(actionSingle_Page);
+	pageModeGroup->addAction(actionContinuous);
+	pageModeGroup->addAction(actionFacing_Pages);
+	pageModeMapper->setMapping(actionSingle_Page, kSinglePage);
+	pageModeMapper->setMapping(actionContinuous, kContinuous);
+	pageModeMapper->setMapping(actionFacing_Pages, kFacingPages);
+	connect(actionSingle_Page, SIGNAL(triggered()), pageModeMapper, SLOT(map()));
+	connect(actionContinuous, SIGNAL(triggered()), pageModeMapper, SLOT(map()));
+	connect(actionFacing_Pages, SIGNAL(triggered()), pageModeMapper, SLOT(map()));
+	connect(pageModeMapper, SIGNAL(mapped(int)), pdfWidget, SLOT(setPageMode(int)));
+	connect(pdfWidget, SIGNAL(changedPageMode(int)), this, SLOT(adjustPageModeActions(int)));
+	adjustPageModeActions(pdfWidget->pageMode());
 	connect(pdfWidget, SIGNAL(syncClick(int, const QPointF&)), this, SLOT(syncClick(int, const QPointF&)));
 
 	if (actionZoom_In->shortcut() == QKeySequence("Ctrl++"))
@@ -1255,6 +1865,7 @@ PDFDocument::init()
 	connect(this, SIGNAL(destroyed()), qApp, SLOT(updateWindowMenus()));
 
 	connect(qApp, SIGNAL(syncPdf(const QString&, int, bool)), this, SLOT(syncFromSource(const QString&, int, bool)));
+	connect(qApp, SIGNAL(sourceLinesVisible(const QString&, int, int)), this, SLOT(sourceLinesVisible(const QString&, int, int)));
 
 	menuShow->addAction(toolBar->toggleViewAction());
 	menuShow->addSeparator();
@@ -1273,6 +1884,13 @@ PDFDocument::init()
 	connect(this, SIGNAL(reloaded()), dw, SLOT(documentLoaded()));
 	connect(pdfWidget, SIGNAL(changedPage(int)), dw, SLOT(pageChanged(int)));
 
+	dw = new PDFThumbnailDock(this);
+	dw->hide();
+	addDockWidget(Qt::LeftDockWidgetArea, dw);
+	menuShow->addAction(dw->toggleViewAction());
+	connect(this, SIGNAL(reloaded()), dw, SLOT(documentLoaded()));
+	connect(pdfWidget, SIGNAL(changedPage(int)), dw, SLOT(pageChanged(int)));
+
 	dw = new PDFFontsDock(this);
 	dw->hide();
 	addDockWidget(Qt::BottomDockWidgetArea, dw);
@@ -1396,47 +2014,99 @@ void PDFDocument::loadFile(const QString &fileName)
 	}
 }
 
-void PDFDocument::reload()
+// run in a worker thread; the document is handed over to the GUI thread
+// once it is loaded
+static PDFLoadedDocumentPointer loadPopplerDocument(const QString& fileName)
 {
-	QApplication::setOverrideCursor(Qt::WaitCursor);
+	Poppler::Document *doc = Poppler::Document::load(fileName);
+	QVector<QSizeF> pageSizes;
+	if (doc != NULL && !doc->isLocked()) {
+		doc->setRenderBackend(Poppler::Document::SplashBackend);
+		doc->setRenderHint(Poppler::Document::Antialiasing);
+		doc->setRenderHint(Poppler::Document::TextAntialiasing);
+//		globalParams->setScreenType(screenDispersed);
 
-	if (scanner != NULL) {
-		synctex_scanner_free(scanner);
-		scanner = NULL;
+		// the view's layout needs the size of every page
+		pageSizes.resize(doc->numPages());
+		for (int i = 0; i < pageSizes.size(); ++i) {
+			Poppler::Page *page = doc->page(i);
+			if (page != NULL) {
+				pageSizes[i] = page->pageSizeF();
+				delete page;
+			}
+		}
 	}
+	return PDFLoadedDocumentPointer(new PDFLoadedDocument(doc, pageSizes));
+}
 
-	if (document != NULL)
-		delete document;
+void PDFDocument::reload()
+{
+	if (loadingDocument) {
+		// the file changed again while it was being loaded
+		documentReloadPending = true;
+		return;
+	}
 
-	document = Poppler::Document::load(curFile);
-	if (document != NULL) {
-		if (document->isLocked()) {
-			delete document;
-			document = NULL;
-			statusBar()->showMessage(tr("PDF file \"%1\" is locked; this is not currently supported.")
-									 .arg(TWUtils::strippedName(curFile)));
-			pdfWidget->hide();
-		}
-		else {
-			document->setRenderBackend(Poppler::Document::SplashBackend);
-			document->setRenderHint(Poppler::Document::Antialiasing);
-			document->setRenderHint(Poppler::Document::TextAntialiasing);
-//			globalParams->setScreenType(screenDispersed);
-
-			pdfWidget->setDocument(document);
-			pdfWidget->show();
-			pdfWidget->setFocus();
-
-			loadSyncData();
-			emit reloaded();
-		}
+	// tiles of the load being replaced stay cached for now, as the preview
+	// shows them until the new ones are ready; anything older is dropped
+	PDFRenderCache::instance()->invalidate(previousDocKey);
+	previousDocKey = renderer->documentKey();
+	renderer->setFileName(curFile);
+
+	// the current document stays on display until the new one is ready
+	loadingDocument = true;
+	documentLoader->setFuture(QtConcurrent::run(loadPopplerDocument, curFile));
+}
+
+void PDFDocument::documentLoadFinished()
+{
+	if (!loadingDocument)
+		return;
+	PDFLoadedDocumentPointer loaded = documentLoader->result();
+	loadingDocument = false;
+	if (documentReloadPending) {
+		documentReloadPending = false;
+		reload();
+		return;
 	}
-	else {
+	Poppler::Document *newDocument = loaded->take();
+	QVector<QSizeF> pageSizes = loaded->pageSizes;
+
+	Poppler::Document *oldDocument = document;
+	document = NULL;
+	stopFindAll();
+	lastSearchResult = PDFSearchResult();
+	if (newDocument == NULL) {
 		statusBar()->showMessage(tr("Failed to load file \"%1\"; perhaps it is not a valid PDF document.")
 									.arg(TWUtils::strippedName(curFile)));
+		pdfWidget->setDocument(NULL);
+		pdfWidget->hide();
+	}
+	else if (newDocument->isLocked()) {
+		delete newDocument;
+		statusBar()->showMessage(tr("PDF file \"%1\" is locked; this is not currently supported.")
+								 .arg(TWUtils::strippedName(curFile)));
+		pdfWidget->setDocument(NULL);
 		pdfWidget->hide();
 	}
-	QApplication::restoreOverrideCursor();
+	else {
+		document = newDocument;
+		// must come before the renderer is asked for tiles of the new document,
+		// which may report unchanged pages right away
+		textLayer->setDocument(curFile, document->numPages(), renderer->documentKey());
+		pdfWidget->setDocument(document, pageSizes);
+		pdfWidget->show();
+		pdfWidget->setFocus();
+	}
+	delete oldDocument;
+
+	discardSyncIndex();
+	// clicks refer to the previous version of the document
+	pendingClickPage = -1;
+	if (document != NULL) {
+		loadSyncData();
+		emit reloaded();
+	}
 }
 
 void PDFDocument::reloadWhenIdle()
@@ -1454,78 +2124,313 @@ void PDFDocument::reloadWhenIdle()
 
 void PDFDocument::loadSyncData()
 {
-	scanner = synctex_scanner_new_with_output_file(curFile.toUtf8().data(), NULL, 1);
-	if (scanner == NULL)
+	if (loadingSyncData) {
+		syncReloadPending = true;
+		return;
+	}
+	loadingSyncData = true;
+	syncLoader->setFuture(QtConcurrent::run(SyncTeXIndex::load, curFile));
+}
+
+void PDFDocument::syncDataLoadFinished()
+{
+	SyncTeXIndexPointer newIndex = syncLoader->result();
+	loadingSyncData = false;
+	if (syncReloadPending) {
+		syncReloadPending = false;
+		loadSyncData();
+		return;
+	}
+	if (document == NULL) {
+		// the document failed to load in the meantime
+		return;
+	}
+
+	syncIndex = newIndex;
+	syncSourceTags.clear();
+	if (syncIndex == NULL)
 		statusBar()->showMessage(tr("No SyncTeX data available"), kStatusMessageDuration);
-	else {
-		QString synctexName = QString::fromUtf8(synctex_scanner_get_synctex(scanner));
-		statusBar()->showMessage(tr("SyncTeX: \"%1\"").arg(synctexName), kStatusMessageDuration);
+	else
+		statusBar()->showMessage(tr("SyncTeX: \"%1\"").arg(syncIndex->synctexFileName()), kStatusMessageDuration);
+	updateSourceOverlay();
+
+	processPendingSyncRequests();
+}
+
+// drops the SyncTeX data; loads and queries still running on it keep it
+// alive until they are done, and their results are ignored
+void PDFDocument::discardSyncIndex()
+{
+	loadingSyncPages = false;
+	runningSyncQuery = false;
+	runningOverlayQuery = false;
+	overlayQueryPending = false;
+	syncIndex = SyncTeXIndexPointer();
+	syncSourceTags.clear();
+	updateSourceOverlay();
+}
+
+// run in a worker thread
+static void loadSyncPages(SyncTeXIndexPointer index, const QList<int>& pages)
+{
+	index->loadPages(pages);
+}
+
+// returns true if the given pages of the SyncTeX data are ready for a query;
+// otherwise, they are loaded in the background
+bool PDFDocument::syncPagesReady(const QList<int>& pages)
+{
+	if (syncIndex->isLoaded(pages))
+		return true;
+	loadingSyncPages = true;
+	syncPageLoader->setFuture(QtConcurrent::run(loadSyncPages, syncIndex, pages));
+	return false;
+}
+
+void PDFDocument::syncPagesLoaded()
+{
+	// the load may belong to SyncTeX data discarded when the document changed
+	// (possibly followed by a new one, which is still running)
+	if (!loadingSyncPages || !syncPageLoader->isFinished())
+		return;
+	loadingSyncPages = false;
+	processPendingSyncRequests();
+}
+
+void PDFDocument::processPendingSyncRequests()
+{
+	if (pendingClickPage >= 0) {
+		int page = pendingClickPage;
+		pendingClickPage = -1;
+		syncClick(page, pendingClickPos);
+	}
+	if (pendingSyncLine >= 0) {
+		int line = pendingSyncLine;
+		pendingSyncLine = -1;
+		syncFromSource(pendingSyncFile, line, pendingSyncActivate);
 	}
 }
 
 void PDFDocument::syncClick(int pageIndex, const QPointF& pos)
 {
-	if (scanner == NULL)
+	if (!loadingSyncData && !loadingSyncPages && syncIndex == NULL)
+		return;
+	if (loadingSyncData || loadingSyncPages || !syncPagesReady(syncIndex->pagesForEditQuery(pageIndex))) {
+		// answered once the data is there
+		pendingClickPage = pageIndex;
+		pendingClickPos = pos;
 		return;
+	}
 	pdfWidget->setHighlightPath(QPainterPath());
 	pdfWidget->update();
-	if (synctex_edit_query(scanner, pageIndex + 1, pos.x(), pos.y()) > 0) {
-		synctex_node_t node;
-		while ((node = synctex_next_result(scanner)) != NULL) {
-			QString filename = QString::fromUtf8(synctex_scanner_get_name(scanner, synctex_node_tag(node)));
-			QDir curDir(QFileInfo(curFile).canonicalPath());
-			TeXDocument::openDocument(QFileInfo(curDir, filename).canonicalFilePath(), true, true, synctex_node_line(node));
-			break; // FIXME: currently we just take the first hit
-		}
+	int tag, line;
+	if (syncIndex->editQuery(pageIndex, pos, tag, line)) {
+		QString filename = syncIndex->inputs().value(tag);
+		QDir curDir(QFileInfo(curFile).canonicalPath());
+		TeXDocument::openDocument(QFileInfo(curDir, filename).canonicalFilePath(), true, true, line);
 	}
 }
 
-void PDFDocument::syncFromSource(const QString& sourceFile, int lineNo, bool activatePreview)
+static PDFSyncResult runSyncQuery(SyncTeXIndexPointer index, int tag, int line)
 {
-	if (scanner == NULL)
-		return;
+	PDFSyncResult result;
+	result.pageIdx = index->displayQuery(tag, line, result.rects);
+	return result;
+}
+
+// returns the SyncTeX input tag of the given source file, or -1
+int PDFDocument::syncTag(const QString& sourceFile)
+{
+	QHash<QString, int>::const_iterator cached = syncSourceTags.constFind(sourceFile);
+	if (cached != syncSourceTags.constEnd())
+		return cached.value();
 
-	// find the name synctex is using for this source file...
 	const QFileInfo sourceFileInfo(sourceFile);
 	QDir curDir(QFileInfo(curFile).canonicalPath());
-	synctex_node_t node = synctex_scanner_input(scanner);
-	QString name;
-	bool found = false;
-	while (node != NULL) {
-		name = QString::fromUtf8(synctex_scanner_get_name(scanner, synctex_node_tag(node)));
-		const QFileInfo fi(curDir, name);
-		if (fi == sourceFileInfo) {
-			found = true;
+	int tag = -1;
+	QMap<int, QString>::const_iterator i;
+	for (i = syncIndex->inputs().constBegin(); i != syncIndex->inputs().constEnd(); ++i) {
+		if (QFileInfo(curDir, i.value()) == sourceFileInfo) {
+			tag = i.key();
 			break;
 		}
-		node = synctex_node_sibling(node);
 	}
-	if (!found)
+	syncSourceTags.insert(sourceFile, tag);
+	return tag;
+}
+
+void PDFDocument::syncFromSource(const QString& sourceFile, int lineNo, bool activatePreview)
+{
+	if (loadingDocument || loadingSyncData || loadingSyncPages || runningSyncQuery) {
+		// only the most recent request is worth carrying out once the data is there
+		pendingSyncFile = sourceFile;
+		pendingSyncLine = lineNo;
+		pendingSyncActivate = activatePreview;
+		return;
+	}
+	if (syncIndex == NULL)
+		return;
+
+	int tag = syncTag(sourceFile);
+	if (tag < 0)
 		return;
 
-	if (synctex_display_query(scanner, name.toUtf8().data(), lineNo, 0) > 0) {
-		int page = -1;
+	// parsing the pages involved may take a while, so the query runs in the
+	// background
+	runningSyncQuery = true;
+	syncQueryActivate = activatePreview;
+	syncQuery->setFuture(QtConcurrent::run(runSyncQuery, syncIndex, tag, lineNo));
+}
+
+void PDFDocument::syncQueryFinished()
+{
+	// the query may belong to SyncTeX data discarded when the document changed
+	if (!runningSyncQuery || !syncQuery->isFinished())
+		return;
+	runningSyncQuery = false;
+	// a newer request makes this result obsolete
+	if (pendingSyncLine >= 0) {
+		processPendingSyncRequests();
+		return;
+	}
+
+	PDFSyncResult result = syncQuery->result();
+	if (result.pageIdx >= 0) {
 		QPainterPath path;
-		while ((node = synctex_next_result(scanner)) != NULL) {
-			if (page == -1)
-				page = synctex_node_page(node);
-			if (synctex_node_page(node) != page)
-				continue;
-			QRectF nodeRect(synctex_node_box_visible_h(node),
-							synctex_node_box_visible_v(node) - synctex_node_box_visible_height(node),
-							synctex_node_box_visible_width(node),
-							synctex_node_box_visible_height(node) + synctex_node_box_visible_depth(node));
-			path.addRect(nodeRect);
-		}
-		if (page > 0) {
-			pdfWidget->goToPage(page - 1);
-			path.setFillRule(Qt::WindingFill);
-			pdfWidget->setHighlightPath(path);
-			pdfWidget->update();
-			if (activatePreview)
-				selectWindow();
+		foreach (const QRectF& rect, result.rects)
+			path.addRect(rect);
+		pdfWidget->goToPage(result.pageIdx);
+		path.setFillRule(Qt::WindingFill);
+		pdfWidget->setHighlightPath(path);
+		pdfWidget->update();
+		if (syncQueryActivate)
+			selectWindow();
+	}
+	processPendingSyncRequests();
+}
+
+QMap<int, QList<QRectF> > PDFDocument::syncRectsForLines(const QString& sourceFile, int firstLine, int lastLine)
+{
+	if (loadingSyncData || syncIndex == NULL)
+		return QMap<int, QList<QRectF> >();
+	int tag = syncTag(sourceFile);
+	if (tag < 0)
+		return QMap<int, QList<QRectF> >();
+	return syncIndex->displayRangeQuery(tag, firstLine, lastLine);
+}
+
+QMap<QString, QList<int> > PDFDocument::syncLinesForPage(int pageIndex)
+{
+	QMap<QString, QList<int> > result;
+	if (loadingSyncData || syncIndex == NULL)
+		return result;
+	QDir curDir(QFileInfo(curFile).canonicalPath());
+	QHash<int, QString> fileNames;
+	typedef QPair<int, int> TagLine;
+	foreach (const TagLine& tagLine, syncIndex->pageLines(pageIndex)) {
+		if (!fileNames.contains(tagLine.first))
+			fileNames.insert(tagLine.first, QFileInfo(curDir, syncIndex->inputs().value(tagLine.first)).canonicalFilePath());
+		result[fileNames.value(tagLine.first)] << tagLine.second;
+	}
+	return result;
+}
+
+QList<QVariant> PDFDocument::syncLinesToRects(const QString& sourceFile, int firstLine, int lastLine)
+{
+	QList<QVariant> result;
+	QMap<int, QList<QRectF> > pages = syncRectsForLines(sourceFile, firstLine, lastLine);
+	for (QMap<int, QList<QRectF> >::const_iterator i = pages.constBegin(); i != pages.constEnd(); ++i) {
+		QList<QVariant> rects;
+		foreach (const QRectF& r, i.value()) {
+			QMap<QString, QVariant> rect;
+			rect["x"] = r.x();
+			rect["y"] = r.y();
+			rect["width"] = r.width();
+			rect["height"] = r.height();
+			rects << rect;
 		}
+		QMap<QString, QVariant> page;
+		page["page"] = i.key();
+		page["rects"] = rects;
+		result << page;
 	}
+	return result;
+}
+
+QList<QVariant> PDFDocument::syncPageToLines(int pageIndex)
+{
+	QList<QVariant> result;
+	QMap<QString, QList<int> > files = syncLinesForPage(pageIndex);
+	for (QMap<QString, QList<int> >::const_iterator i = files.constBegin(); i != files.constEnd(); ++i) {
+		QList<QVariant> lines;
+		foreach (int line, i.value())
+			lines << line;
+		QMap<QString, QVariant> file;
+		file["file"] = i.key();
+		file["lines"] = lines;
+		result << file;
+	}
+	return result;
+}
+
+void PDFDocument::sourceLinesVisible(const QString& sourceFile, int firstLine, int lastLine)
+{
+	// source windows of files that are not part of this PDF are ignored
+	if (syncIndex != NULL && syncTag(sourceFile) < 0)
+		return;
+	// edits and resizes often leave the range as it was
+	if (sourceFile == visibleSourceFile && firstLine == visibleFirstLine && lastLine == visibleLastLine)
+		return;
+	visibleSourceFile = sourceFile;
+	visibleFirstLine = firstLine;
+	visibleLastLine = lastLine;
+	updateSourceOverlay();
+}
+
+static QMap<int, QList<QRectF> > runOverlayQuery(SyncTeXIndexPointer index, int tag, int firstLine, int lastLine)
+{
+	return index->displayRangeQuery(tag, firstLine, lastLine);
+}
+
+void PDFDocument::updateSourceOverlay()
+{
+	if (!actionShow_Visible_Source->isChecked()) {
+		overlayQueryPending = false;
+		pdfWidget->setSourceOverlay(QMap<int, QList<QRectF> >());
+		return;
+	}
+	// until a source window reports its lines, use the one we were opened from
+	if (visibleFirstLine < 0 && !sourceDocList.isEmpty()) {
+		visibleSourceFile = sourceDocList.first()->fileName();
+		sourceDocList.first()->visibleLines(visibleFirstLine, visibleLastLine);
+	}
+	if (runningOverlayQuery) {
+		// only the latest range is worth querying once this one is done
+		overlayQueryPending = true;
+		return;
+	}
+	overlayQueryPending = false;
+	int tag = (loadingSyncData || syncIndex == NULL ? -1 : syncTag(visibleSourceFile));
+	if (tag < 0) {
+		pdfWidget->setSourceOverlay(QMap<int, QList<QRectF> >());
+		return;
+	}
+	// the pages involved may have to be parsed, so this runs in the background
+	runningOverlayQuery = true;
+	overlayQuery->setFuture(QtConcurrent::run(runOverlayQuery, syncIndex, tag, visibleFirstLine, visibleLastLine));
+}
+
+void PDFDocument::overlayQueryFinished()
+{
+	// the query may belong to SyncTeX data discarded when the document changed
+	if (!runningOverlayQuery || !overlayQuery->isFinished())
+		return;
+	runningOverlayQuery = false;
+	// the range or the setting may have changed in the meantime
+	if (overlayQueryPending || !actionShow_Visible_Source->isChecked())
+		updateSourceOverlay();
+	else
+		pdfWidget->setSourceOverlay(overlayQuery->result());
 }
 
 void PDFDocument::setCurrentFile(const QString &fileName)
@@ -1614,6 +2519,13 @@ void PDFDocument::adjustScaleActions(autoScaleOption scaleOption)
 	actionFit_to_Width->setChecked(scaleOption == kFitWidth);
 }
 
+void PDFDocument::adjustPageModeActions(int mode)
+{
+	actionSingle_Page->setChecked(mode == kSinglePage);
+	actionContinuous->setChecked(mode == kContinuous);
+	actionFacing_Pages->setChecked(mode == kFacingPages);
+}
+
 void PDFDocument::toggleFullScreen()
 {
 	if (windowState() & Qt::WindowFullScreen) {
@@ -1713,9 +2625,7 @@ void PDFDocument::doFindAgain(bool newSearch /* = false */)
 {
 	QSETTINGS_OBJECT(settings);
 	int pageIdx;
-	Poppler::Page *page;
-	Poppler::Page::SearchMode searchMode = Poppler::Page::CaseInsensitive;
-	Poppler::Page::SearchDirection searchDir; // = Poppler::Page::FromTop;
+	Qt::CaseSensitivity cs = Qt::CaseInsensitive;
 	int deltaPage, firstPage, lastPage;
 	int run, runs;
 	bool backwards = false;
@@ -1730,17 +2640,24 @@ void PDFDocument::doFindAgain(bool newSearch /* = false */)
 	QTextDocument::FindFlags flags = (QTextDocument::FindFlags)settings.value("searchFlags").toInt();
 
 	if ((flags & QTextDocument::FindCaseSensitively) != 0)
-		searchMode = Poppler::Page::CaseSensitive;
+		cs = Qt::CaseSensitive;
 	if ((flags & QTextDocument::FindBackward) != 0)
 		backwards = true;
 
+	if (newSearch && settings.value("pdfSearchFindAll").toBool()) {
+		findAll(searchText, cs);
+		return;
+	}
+
+	// once the text layer is complete, searches don't need to touch the PDF
+	textLayer->extract();
+
 	deltaPage = (backwards ? -1 : +1);
 
 	if (newSearch) {
 		lastSearchResult.selRect = QRectF();
 		firstSearchPage = pdfWidget->getCurrentPageIndex();
 	}
-	searchDir = (backwards ? Poppler::Page::PreviousResult : Poppler::Page::NextResult);
 	
 	runs = (settings.value("searchWrap").toBool() ? 2 : 1);
 
@@ -1762,30 +2679,96 @@ void PDFDocument::doFindAgain(bool newSearch /* = false */)
 		}
 		
 		for (pageIdx = firstPage; pageIdx != lastPage; pageIdx += deltaPage) {
-			page = document->page(pageIdx);
-
-			if (page->search(searchText, lastSearchResult.selRect, searchDir, searchMode)) {
-				lastSearchResult.doc = this;
-				lastSearchResult.pageIdx = pageIdx;
-				QPainterPath p;
-				p.addRect(lastSearchResult.selRect);
-
-				if (hasSyncData() && settings.value("searchPdfSync").toBool()) {
-					emit syncClick(pageIdx, lastSearchResult.selRect.center());
+			QList<PDFTextMatch> matches;
+			if (textLayer->hasPage(pageIdx))
+				matches = textLayer->page(pageIdx).search(searchText, cs);
+			else {
+				Poppler::Page *page = document->page(pageIdx);
+				if (page != NULL) {
+					matches = PDFTextPage::extract(page, pageIdx).search(searchText, cs);
+					delete page;
 				}
+			}
 
-				pdfWidget->goToPage(lastSearchResult.pageIdx);
-				pdfWidget->setHighlightPath(p);
-				pdfWidget->update();
-				selectWindow();
+			// continue after the previous result if it is on this page
+			int current = -1;
+			if (!lastSearchResult.selRect.isNull() && lastSearchResult.pageIdx == pageIdx) {
+				for (int i = 0; i < matches.count(); ++i) {
+					if (matches[i].rect == lastSearchResult.selRect)
+						current = i;
+				}
+			}
+			int next;
+			if (current >= 0)
+				next = current + deltaPage;
+			else
+				next = (backwards ? matches.count() - 1 : 0);
+
+			if (next >= 0 && next < matches.count()) {
+				showSearchResult(PDFSearchResult(this, pageIdx, matches[next].rect));
 				return;
 			}
 			lastSearchResult.selRect = QRectF();
-			searchDir = (backwards ? Poppler::Page::PreviousResult : Poppler::Page::NextResult);
 		}
 	}
 }
 
+void PDFDocument::showSearchResult(const PDFSearchResult& result)
+{
+	QSETTINGS_OBJECT(settings);
+	lastSearchResult = result;
+	QPainterPath p;
+	p.addRect(result.selRect);
+
+	if (hasSyncData() && settings.value("searchPdfSync").toBool()) {
+		emit syncClick(result.pageIdx, result.selRect.center());
+	}
+
+	pdfWidget->goToPage(result.pageIdx);
+	pdfWidget->setHighlightPath(p);
+	pdfWidget->update();
+	selectWindow();
+}
+
+void PDFDocument::findAll(const QString& searchText, Qt::CaseSensitivity cs)
+{
+	stopFindAll();
+	findAllText = searchText;
+	findAllCaseSensitivity = cs;
+	findAllResults = PDFSearchResults::presentResults(searchText, this);
+
+	// pages whose text is known are searched right away (in parallel), the
+	// others as soon as they have been extracted
+	findAllSearcher = new QFutureWatcher< QList<PDFTextMatch> >(this);
+	connect(findAllSearcher, SIGNAL(resultReadyAt(int)), this, SLOT(findAllResultsReady(int)));
+	findAllSearcher->setFuture(QtConcurrent::mapped(textLayer->availablePages(), PDFTextSearch(searchText, cs)));
+	textLayer->extract();
+}
+
+void PDFDocument::stopFindAll()
+{
+	findAllText = QString();
+	if (findAllSearcher != NULL) {
+		findAllSearcher->cancel();
+		findAllSearcher->disconnect(this);
+		findAllSearcher->deleteLater();
+		findAllSearcher = NULL;
+	}
+}
+
+void PDFDocument::findAllResultsReady(int index)
+{
+	if (findAllResults && findAllSearcher != NULL)
+		findAllResults->addMatches(findAllSearcher->resultAt(index), textLayer);
+}
+
+void PDFDocument::findAllPageExtracted(int index)
+{
+	if (findAllText.isEmpty() || !findAllResults)
+		return;
+	findAllResults->addMatches(textLayer->page(index).search(findAllText, findAllCaseSensitivity), textLayer);
+}
+
 void PDFDocument::print()
 {
 	// Currently, printing is not supported in a reliable, cross-platform way
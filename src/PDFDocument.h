@@ -32,11 +32,18 @@
 #include <QPainterPath>
 #include <QTimer>
 #include <QMouseEvent>
+#include <QHash>
+#include <QVector>
+#include <QFutureWatcher>
+#include <QPointer>
+#include <QSharedData>
 
 #include "TWApp.h"
 #include "FindDialog.h"
+#include "PDFRenderer.h"
+#include "PDFTextLayer.h"
 #include "poppler-qt4.h"
-#include "synctex_parser.h"
+#include "SyncTeXIndex.h"
 
 #include "ui_PDFDocument.h"
 
@@ -44,6 +51,7 @@ const int kDefault_MagnifierSize = 2;
 const bool kDefault_CircularMagnifier = true;
 const int kDefault_PreviewScaleOption = 1;
 const int kDefault_PreviewScale = 200;
+const int kDefault_PrefetchPages = 2;
 
 const int kPDFWindowStateVersion = 1;
 
@@ -54,29 +62,92 @@ class QScrollArea;
 class TeXDocument;
 class QShortcut;
 class QFileSystemWatcher;
+class PDFWidget;
 
+// Holds a Poppler document loaded in the background until the window takes
+// it; a load that is no longer wanted is deleted along with the holder.
+// The sizes of all pages are found by the loader as well, as getting them
+// means creating each page.
+class PDFLoadedDocument : public QSharedData
+{
+public:
+	PDFLoadedDocument(Poppler::Document *doc = NULL, const QVector<QSizeF>& sizes = QVector<QSizeF>())
+		: pageSizes(sizes), document(doc) { }
+	~PDFLoadedDocument() { delete document; }
+
+	Poppler::Document *take()
+		{ Poppler::Document *doc = document; document = NULL; return doc; }
+
+	QVector<QSizeF>	pageSizes;
+
+private:
+	Poppler::Document	*document;
+};
+
+typedef QExplicitlySharedDataPointer<PDFLoadedDocument> PDFLoadedDocumentPointer;
+
+// outcome of a source-to-preview sync query run in the background
+class PDFSyncResult
+{
+public:
+	PDFSyncResult() : pageIdx(-1) { }
+
+	int	pageIdx;	// -1 if the line was not found
+	QList<QRectF>	rects;
+};
+
+// Shows the part of the PDFWidget around its center at twice the size. The
+// magnified tiles are rendered in the background (like those of the main
+// view), so painting the magnifier only copies cached images.
 class PDFMagnifier : public QLabel
 {
 	Q_OBJECT
 
 public:
-	PDFMagnifier(QWidget *parent, qreal inDpi);
-	void setPage(Poppler::Page *p, qreal scale);
+	PDFMagnifier(PDFWidget *parent, qreal inDpi);
+	void setScale(qreal scale);
 
 protected:
 	virtual void paintEvent(QPaintEvent *event);
 	virtual void resizeEvent(QResizeEvent *event);
+	virtual void moveEvent(QMoveEvent *event);
+	virtual void showEvent(QShowEvent *event);
+	virtual void hideEvent(QHideEvent *event);
+
+private slots:
+	void tileRendered(const PDFPageTile& tile, const QImage& image);
 
 private:
-	Poppler::Page	*page;
+	QPoint magnifiedOrigin() const;
+	QList<PDFPageTile> tilesForRect(const QRect& r, QHash<int, QPoint>& pageOffsets) const;
+	void requestTiles();
+
+	PDFWidget	*pdfWidget;
 	qreal	scaleFactor;
 	qreal	parentDpi;
-	QImage	image;
-	
-	QPoint	imageLoc;
-	QSize	imageSize;
-	qreal	imageDpi;
-	Poppler::Page	*imagePage;
+};
+
+// Spatial index of the links on a page. Poppler creates new Link objects on
+// every call to Page::links(), so they are fetched once and owned here; the
+// links are sorted into a grid of cells over the page for hit-testing.
+class PDFLinkIndex
+{
+public:
+	PDFLinkIndex(Poppler::Page *page);
+	~PDFLinkIndex();
+
+	// pos is relative to the page size, like Poppler::Link::linkArea()
+	Poppler::Link *linkAt(const QPointF& pos) const;
+	bool contains(const Poppler::Link *link) const { return links.contains(const_cast<Poppler::Link*>(link)); }
+
+private:
+	int cellIndex(int column, int row) const { return row * kGridSize + column; }
+	static int gridCoordinate(qreal pos);
+
+	static const int kGridSize = 16;
+
+	QList<Poppler::Link*>	links;
+	QVector< QList<Poppler::Link*> >	cells;
 };
 
 typedef enum {
@@ -85,15 +156,28 @@ typedef enum {
 	kFitWindow
 } autoScaleOption;
 
+typedef enum {
+	kSinglePage,
+	kContinuous,	// all pages in one column
+	kFacingPages	// all pages, two per row
+} pageModeOption;
+
+const int kDefault_PageMode = kSinglePage;
+
 class PDFWidget : public QLabel
 {
 	Q_OBJECT
 
+	friend class PDFMagnifier;
+
 public:
 	PDFWidget();
 	virtual ~PDFWidget();
 	
-	void setDocument(Poppler::Document *doc);
+	void setRenderer(PDFRenderer *r);
+	// sizes are those of the document's pages (in points), as found when it
+	// was loaded
+	void setDocument(Poppler::Document *doc, const QVector<QSizeF>& sizes = QVector<QSizeF>());
 
 	void saveState(); // used when toggling full screen mode
 	void restoreState();
@@ -101,10 +185,16 @@ public:
 	void resetMagnifier();
 	void goToPage(int pageIndex);
 	void setHighlightPath(const QPainterPath& path);
+	// boxes (in points) to shade on each page, keyed by page index
+	void setSourceOverlay(const QMap<int, QList<QRectF> >& rects);
 	void goToDestination(const QString& destName);
 	int getCurrentPageIndex() { return pageIndex; }
 	void reloadPage();
 	void updateStatusBar();
+	pageModeOption pageMode() const { return pageModeOpt; }
+	// the size (in points) of a page, found when the document was loaded;
+	// invalid for an index out of range
+	QSizeF pageSize(int index) const { return pageSizes.value(index, QSizeF()); }
 
 private slots:
 	void goFirst();
@@ -123,6 +213,7 @@ private slots:
 	void rightOrNext();
 
 	void clearHighlight();
+	void tileRendered(const PDFPageTile& tile, const QImage& image);
 	
 public slots:
 	void windowResized();
@@ -130,11 +221,14 @@ public slots:
 	void fitWidth(bool checked = true);
 	void fitWindow(bool checked = true);
 	void setTool(int tool);
+	void setPageMode(int mode);
+	void scrolled();
 
 signals:
 	void changedPage(int);
 	void changedZoom(qreal);
 	void changedScaleOption(autoScaleOption);
+	void changedPageMode(int);
 	void syncClick(int, const QPointF&);
 
 protected:
@@ -163,6 +257,19 @@ private:
 	void doLink(const Poppler::Link *link);
 	void doZoom(const QPoint& clickPos, int dir);
 	QScrollArea* getScrollArea();
+	QList<PDFPageTile> tilesForRect(int index, const QRect& r) const;
+	PDFPageTile placeholderTile(int index) const;
+	void prefetchPages();
+	QList<PDFPageTile> pageTiles(int index, qreal renderDpi) const;
+
+	void layoutPages();
+	void scrollToPage(int index);
+	QRect pageRect(int index) const;
+	QList<int> pagesInRect(const QRect& r) const;
+	int mapToPage(const QPoint& pos, QPointF& pagePos) const;
+	Poppler::Page *popplerPage(int index);
+	void releaseInvisiblePages();
+	Poppler::Link *linkAt(const QPoint& pos, QRectF *area = NULL);
 	
 	Poppler::Document	*document;
 	Poppler::Page		*page;
@@ -172,6 +279,15 @@ private:
 	qreal	scaleFactor;
 	qreal	dpi;
 	autoScaleOption scaleOption;
+	pageModeOption	pageModeOpt;
+
+	// for continuous modes: page rects (in points) in the combined layout;
+	// only pages near the visible area have a materialized Poppler::Page
+	QVector<QRectF>	pageLayout;
+	QSizeF	layoutSize;
+	QVector<QSizeF>	pageSizes;
+	QHash<int, Poppler::Page*>	loadedPages;
+	QHash<int, PDFLinkIndex*>	linkIndexes;	// built on demand for loaded pages
 
 	qreal			saveScaleFactor;
 	autoScaleOption	saveScaleOption;
@@ -183,17 +299,23 @@ private:
 	QShortcut *shortcutDown;
 	QShortcut *shortcutRight;
 	
-	QImage	image;
-	QRect	imageRect;
-	qreal	imageDpi;
-	Poppler::Page	*imagePage;
+	PDFRenderer	*renderer;
+	quint64	docKey;
+	quint64	staleDocKey;	// tiles of the previous load are shown until fresh ones arrive
+	QImage	placeholder;
+	PDFPageTile	placeholderKey;
+	PDFPageTile	prefetchKey;	// page and resolution the current prefetch was issued for
+	int		navigationDirection;	// +1 when paging forward, -1 when paging backward
+	int		loadedPageIndex;
 
 	PDFMagnifier	*magnifier;
 	int		currentTool;	// the current tool selected in the toolbar
 	int		usingTool;	// the tool actually being used in an ongoing mouse drag
 
 	QPainterPath	highlightPath;
+	int		highlightPage;
 	QTimer highlightRemover;
+	QMap<int, QList<QRectF> >	sourceOverlay;
 	
 	static QCursor	*magnifierCursor;
 	static QCursor	*zoomInCursor;
@@ -228,10 +350,11 @@ public:
 	void enableTypesetAction(bool enabled);
 	void updateTypesettingAction(bool processRunning);
 	void goToDestination(const QString& destName);
+	void showSearchResult(const PDFSearchResult& result);
 	void linkToSource(TeXDocument *texDoc);
 	bool hasSyncData()
 		{
-			return scanner != NULL;
+			return syncIndex != NULL;
 		}
 
 	Poppler::Document *popplerDoc()
@@ -244,6 +367,22 @@ public:
 			return pdfWidget;
 		}
 
+	PDFRenderer *pdfRenderer()
+		{
+			return renderer;
+		}
+
+	// batch SyncTeX queries; they parse all the pages involved right away, and
+	// return nothing while the SyncTeX data is still being loaded
+	// maps the (0-based) indices of pages showing material from the given lines
+	// of sourceFile to the boxes (in points) containing it
+	QMap<int, QList<QRectF> > syncRectsForLines(const QString& sourceFile, int firstLine, int lastLine);
+	// maps the source files that contributed to the given page to their lines
+	QMap<QString, QList<int> > syncLinesForPage(int pageIndex);
+	// the same for scripts (see TWScriptAPI)
+	Q_INVOKABLE QList<QVariant> syncLinesToRects(const QString& sourceFile, int firstLine, int lastLine);
+	Q_INVOKABLE QList<QVariant> syncPageToLines(int pageIndex);
+
 protected:
 	virtual void changeEvent(QEvent *event);
 	virtual bool event(QEvent *event);
@@ -262,6 +401,7 @@ public slots:
 	void goToSource();
 	void toggleFullScreen();
 	void syncFromSource(const QString& sourceFile, int lineNo, bool activatePreview);
+	void sourceLinesVisible(const QString& sourceFile, int firstLine, int lastLine);
 	void print();
 	
 private slots:
@@ -271,8 +411,17 @@ private slots:
 	void enablePageActions(int);
 	void enableZoomActions(qreal);
 	void adjustScaleActions(autoScaleOption);
+	void adjustPageModeActions(int mode);
 	void syncClick(int page, const QPointF& pos);
 	void reloadWhenIdle();
+	void documentLoadFinished();
+	void syncDataLoadFinished();
+	void syncPagesLoaded();
+	void syncQueryFinished();
+	void updateSourceOverlay();
+	void overlayQueryFinished();
+	void findAllResultsReady(int index);
+	void findAllPageExtracted(int index);
 	void scaleLabelClick(QMouseEvent * event) { showScaleContextMenu(event->pos()); }
 	void showScaleContextMenu(const QPoint pos);
 	void setScaleFromContextMenu(const QString & strZoom);
@@ -286,6 +435,12 @@ private:
 	void loadFile(const QString &fileName);
 	void setCurrentFile(const QString &fileName);
 	void loadSyncData();
+	bool syncPagesReady(const QList<int>& pages);
+	void processPendingSyncRequests();
+	int syncTag(const QString& sourceFile);
+	void discardSyncIndex();
+	void findAll(const QString& searchText, Qt::CaseSensitivity cs);
+	void stopFindAll();
 	void saveRecentFileInfo();
 
 	QString curFile;
@@ -296,6 +451,9 @@ private:
 	QScrollArea	*scrollArea;
 	QButtonGroup	*toolButtonGroup;
 
+	PDFRenderer	*renderer;
+	quint64	previousDocKey;
+
 	QList<TeXDocument*> sourceDocList;
 
 	QLabel *pageLabel;
@@ -306,12 +464,59 @@ private:
 	QFileSystemWatcher *watcher;
 	QTimer *reloadTimer;
 	
-	synctex_scanner_t scanner;
+	SyncTeXIndexPointer syncIndex;
+
+	// the PDF and its SyncTeX data are loaded in the background; only one
+	// load of each runs at a time, later requests are deferred until then.
+	// Nothing waits for the workers: their results are dropped if no longer
+	// wanted, and the SyncTeX data stays alive while they use it.
+	QFutureWatcher<PDFLoadedDocumentPointer>	*documentLoader;
+	QFutureWatcher<SyncTeXIndexPointer>	*syncLoader;
+	bool	loadingDocument;
+	bool	documentReloadPending;
+	bool	loadingSyncData;
+	bool	syncReloadPending;
+	// the pages of the SyncTeX data needed by a sync request are parsed in
+	// the background, too
+	QFutureWatcher<void>	*syncPageLoader;
+	bool	loadingSyncPages;
+	// source-to-preview queries run in the background, one at a time
+	QFutureWatcher<PDFSyncResult>	*syncQuery;
+	bool	runningSyncQuery;
+	bool	syncQueryActivate;
+	// so does the query for the source overlay; a range reported meanwhile
+	// is queried once it is done
+	QFutureWatcher< QMap<int, QList<QRectF> > >	*overlayQuery;
+	bool	runningOverlayQuery;
+	bool	overlayQueryPending;
+	// maps source file names to their SyncTeX input tags (-1 if not an input)
+	QHash<QString, int>	syncSourceTags;
+	// the lines last reported visible in a source window, for the overlay
+	QString	visibleSourceFile;
+	int		visibleFirstLine;
+	int		visibleLastLine;
+
+	// sync requests waiting for SyncTeX data; only the latest one in each
+	// direction is kept
+	QString	pendingSyncFile;
+	int		pendingSyncLine;
+	bool	pendingSyncActivate;
+	int		pendingClickPage;
+	QPointF	pendingClickPos;
 
 	bool openedManually;
 	
 	static QList<PDFDocument*> docList;
 	
+	PDFTextLayer	*textLayer;
+
+	// state of a "find all" search; pages are searched as their text becomes
+	// available, results are added to findAllResults
+	QString	findAllText;
+	Qt::CaseSensitivity	findAllCaseSensitivity;
+	QFutureWatcher< QList<PDFTextMatch> >	*findAllSearcher;
+	QPointer<PDFSearchResults>	findAllResults;
+
 	PDFSearchResult lastSearchResult;
 	// stores the page idx a search was started on
 	// after wrapping the search will continue only up to this page
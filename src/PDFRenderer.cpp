@@ -0,0 +1,507 @@
+/*
+	This is part of TeXworks, an environment for working with TeX documents
+	Copyright (C) 2007-2012  Jonathan Kew, Stefan Löffler, Charlie Sharpsteen
+
+	This program is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	For links to further information, or to contact the authors,
+	see <http://www.tug.org/texworks/>.
+*/
+
+#include "PDFRenderer.h"
+#include "TWApp.h"
+
+#include <QMutexLocker>
+#include <QCryptographicHash>
+#include <QFile>
+#include <QBitArray>
+#include <QPair>
+
+// pages can only be compared by their content using poppler's xpdf headers;
+// the build files only define HAVE_POPPLER_XPDF_HEADERS where they find them
+#ifdef HAVE_POPPLER_XPDF_HEADERS
+#define PDF_PAGE_FINGERPRINTS
+#endif
+
+#ifdef PDF_PAGE_FINGERPRINTS
+#include "PDFDoc.h"
+#include "Catalog.h"
+#include "Page.h"
+#include "Object.h"
+#include "Stream.h"
+#include "GooString.h"
+#endif
+
+uint qHash(const PDFPageTile& tile)
+{
+	return qHash(tile.docKey) ^ (uint)(tile.pageIdx << 20) ^ (uint)(tile.dpi * 16)
+			^ (uint)(tile.rect.x() << 10) ^ (uint)tile.rect.y()
+			^ (uint)(tile.rect.width() << 6) ^ (uint)(tile.rect.height() << 2);
+}
+
+#pragma mark === PDFRenderCache ===
+
+PDFRenderCache *PDFRenderCache::theInstance = NULL;
+
+PDFRenderCache *PDFRenderCache::instance()
+{
+	if (theInstance == NULL) {
+		theInstance = new PDFRenderCache;
+		QSETTINGS_OBJECT(settings);
+		theInstance->setMaxSize(settings.value("pdfRenderCacheSize", kDefault_RenderCacheSize).toInt());
+	}
+	return theInstance;
+}
+
+PDFRenderCache::PDFRenderCache()
+	: hitCount(0)
+	, missCount(0)
+{
+}
+
+bool PDFRenderCache::lookup(const PDFPageTile& tile, QImage& image, bool countStatistics)
+{
+	QMutexLocker locker(&mutex);
+	QImage *cached = cache.object(tile);
+	if (countStatistics) {
+		if (cached != NULL)
+			++hitCount;
+		else
+			++missCount;
+	}
+	if (cached == NULL)
+		return false;
+	image = *cached;
+	return true;
+}
+
+bool PDFRenderCache::contains(const PDFPageTile& tile) const
+{
+	QMutexLocker locker(&mutex);
+	return cache.contains(tile);
+}
+
+void PDFRenderCache::insert(const PDFPageTile& tile, const QImage& image)
+{
+	QMutexLocker locker(&mutex);
+	cache.insert(tile, new QImage(image), qMax(1, image.byteCount() / 1024));
+}
+
+void PDFRenderCache::invalidate(quint64 docKey)
+{
+	QMutexLocker locker(&mutex);
+	foreach (const PDFPageTile& tile, cache.keys()) {
+		if (tile.docKey == docKey)
+			cache.remove(tile);
+	}
+}
+
+void PDFRenderCache::transferPages(quint64 fromDocKey, quint64 toDocKey, const PDFPageMapping& pages)
+{
+	QMutexLocker locker(&mutex);
+	QHash<int, int> oldToNew;
+	foreach (int newIdx, pages.keys())
+		oldToNew.insert(pages.value(newIdx), newIdx);
+
+	foreach (const PDFPageTile& tile, cache.keys()) {
+		if (tile.docKey != fromDocKey || !oldToNew.contains(tile.pageIdx))
+			continue;
+		int cost = qMax(1, cache.object(tile)->byteCount() / 1024);
+		QImage *image = cache.take(tile);
+		cache.insert(PDFPageTile(toDocKey, oldToNew.value(tile.pageIdx), tile.dpi, tile.rect), image, cost);
+	}
+}
+
+void PDFRenderCache::clear()
+{
+	QMutexLocker locker(&mutex);
+	cache.clear();
+}
+
+void PDFRenderCache::setMaxSize(int megabytes)
+{
+	QMutexLocker locker(&mutex);
+	cache.setMaxCost(qMax(1, megabytes) * 1024);
+}
+
+int PDFRenderCache::maxSize() const
+{
+	QMutexLocker locker(&mutex);
+	return cache.maxCost() / 1024;
+}
+
+void PDFRenderCache::resetStatistics()
+{
+	QMutexLocker locker(&mutex);
+	hitCount = missCount = 0;
+}
+
+#pragma mark === PDFRenderer ===
+
+quint64 PDFRenderer::lastDocKey = 0;
+
+PDFRenderer::PDFRenderer(QObject *parent)
+	: QThread(parent)
+	, docKey(0)
+	, quit(false)
+{
+	qRegisterMetaType<PDFPageTile>("PDFPageTile");
+	qRegisterMetaType<PDFPageMapping>("PDFPageMapping");
+	// make sure the shared cache is set up in the GUI thread
+	PDFRenderCache::instance();
+}
+
+PDFRenderer::~PDFRenderer()
+{
+	stop();
+	// a render that is already in progress can't be interrupted
+	wait();
+}
+
+void PDFRenderer::stop()
+{
+	QMutexLocker locker(&mutex);
+	quit = true;
+	for (int i = 0; i < kNumChannels; ++i)
+		pending[i].clear();
+	requestAvailable.wakeAll();
+}
+
+quint64 PDFRenderer::setFileName(const QString& name)
+{
+	QMutexLocker locker(&mutex);
+	for (int i = 0; i < kNumChannels; ++i)
+		pending[i].clear();
+	fileName = name;
+	docKey = ++lastDocKey;
+	if (!isRunning())
+		start(QThread::LowPriority);
+	return docKey;
+}
+
+void PDFRenderer::requestTiles(Channel channel, const QList<PDFPageTile>& tiles)
+{
+	QMutexLocker locker(&mutex);
+	pending[channel] = tiles;
+	if (!tiles.isEmpty())
+		requestAvailable.wakeOne();
+}
+
+void PDFRenderer::cancelRequests(Channel channel)
+{
+	QMutexLocker locker(&mutex);
+	pending[channel].clear();
+}
+
+void PDFRenderer::cancelAllRequests()
+{
+	QMutexLocker locker(&mutex);
+	for (int i = 0; i < kNumChannels; ++i)
+		pending[i].clear();
+}
+
+// must be called with the mutex locked
+bool PDFRenderer::takeRequest(PDFPageTile& tile)
+{
+	for (int i = 0; i < kNumChannels; ++i) {
+		while (!pending[i].isEmpty()) {
+			tile = pending[i].takeFirst();
+			if (tile.docKey == docKey)
+				return true;
+		}
+	}
+	return false;
+}
+
+#pragma mark === PDFPageFingerprinter ===
+
+#ifdef PDF_PAGE_FINGERPRINTS
+// Computes a hash for a page of a PDF file that changes whenever the rendered
+// page would: it covers the page geometry, the content streams and everything
+// reachable from the page's resources (fonts, images, nested forms and their
+// resources, patterns, ...). Objects shared by several pages are hashed only
+// once per file.
+class PDFPageFingerprinter
+{
+public:
+	PDFPageFingerprinter(const QString& fileName)
+		: pdfDoc(new GooString(QFile::encodeName(fileName).data()))
+		{ }
+
+	// returns an empty array if the page can't be read
+	QByteArray fingerprint(int pageIdx);
+
+private:
+	void hashObject(QCryptographicHash& hash, Object *obj);
+	void hashDict(QCryptographicHash& hash, Dict *dict);
+	void hashStreamData(QCryptographicHash& hash, Object *obj);
+	QByteArray hashRef(Object *ref);
+
+	PDFDoc	pdfDoc;
+	QHash<QPair<int, int>, QByteArray>	refHashes;
+};
+
+QByteArray PDFPageFingerprinter::fingerprint(int pageIdx)
+{
+	if (!pdfDoc.isOk() || pageIdx < 0 || pageIdx >= pdfDoc.getNumPages())
+		return QByteArray();
+	Page *page = pdfDoc.getCatalog()->getPage(pageIdx + 1);
+	if (page == NULL)
+		return QByteArray();
+
+	QCryptographicHash hash(QCryptographicHash::Md5);
+	PDFRectangle *box = page->getCropBox();
+	hash.addData(QString("%1 %2 %3 %4 %5").arg(box->x1).arg(box->y1).arg(box->x2).arg(box->y2)
+				 .arg(page->getRotate()).toLatin1());
+
+	Object contents;
+	page->getContents(&contents);
+	hashObject(hash, &contents);
+	contents.free();
+
+	// resources are referenced by name from the content streams
+	Dict *resources = page->getResourceDict();
+	if (resources != NULL)
+		hashDict(hash, resources);
+	return hash.result();
+}
+
+void PDFPageFingerprinter::hashObject(QCryptographicHash& hash, Object *obj)
+{
+	switch (obj->getType()) {
+		case objBool:
+			hash.addData(obj->getBool() ? "true " : "false ");
+			break;
+		case objInt:
+			hash.addData(QByteArray::number(obj->getInt()) + ' ');
+			break;
+		case objReal:
+			hash.addData(QByteArray::number(obj->getReal()) + ' ');
+			break;
+		case objString:
+			hash.addData("(");
+			hash.addData(obj->getString()->getCString(), obj->getString()->getLength());
+			hash.addData(")");
+			break;
+		case objName:
+			hash.addData("/");
+			hash.addData(obj->getName());
+			hash.addData(" ");
+			break;
+		case objArray:
+			hash.addData("[");
+			for (int i = 0; i < obj->arrayGetLength(); ++i) {
+				Object elem;
+				obj->arrayGetNF(i, &elem);
+				hashObject(hash, &elem);
+				elem.free();
+			}
+			hash.addData("]");
+			break;
+		case objDict:
+			hashDict(hash, obj->getDict());
+			break;
+		case objStream:
+			hashDict(hash, obj->streamGetDict());
+			hashStreamData(hash, obj);
+			break;
+		case objRef:
+			hash.addData(hashRef(obj));
+			break;
+		default:
+			hash.addData("null ");
+			break;
+	}
+}
+
+void PDFPageFingerprinter::hashDict(QCryptographicHash& hash, Dict *dict)
+{
+	hash.addData("<<");
+	for (int i = 0; i < dict->getLength(); ++i) {
+		Object value;
+		hash.addData("/");
+		hash.addData(dict->getKey(i));
+		hash.addData(" ");
+		dict->getValNF(i, &value);
+		hashObject(hash, &value);
+		value.free();
+	}
+	hash.addData(">>");
+}
+
+void PDFPageFingerprinter::hashStreamData(QCryptographicHash& hash, Object *obj)
+{
+	char buffer[4096];
+	int len = 0, c;
+	obj->streamReset();
+	while ((c = obj->streamGetChar()) != EOF) {
+		buffer[len++] = (char)c;
+		if (len == (int)sizeof(buffer)) {
+			hash.addData(buffer, len);
+			len = 0;
+		}
+	}
+	hash.addData(buffer, len);
+	obj->streamClose();
+}
+
+QByteArray PDFPageFingerprinter::hashRef(Object *ref)
+{
+	QPair<int, int> key(ref->getRefNum(), ref->getRefGen());
+	if (refHashes.contains(key))
+		return refHashes.value(key);
+	// objects referring back to themselves end up here
+	refHashes.insert(key, QByteArray("cycle"));
+
+	Object target;
+	ref->fetch(pdfDoc.getXRef(), &target);
+	QCryptographicHash hash(QCryptographicHash::Md5);
+	hashObject(hash, &target);
+	target.free();
+	QByteArray result = hash.result();
+	refHashes.insert(key, result);
+	return result;
+}
+#else
+// Without the xpdf headers, pages can't be compared reliably (a comparison of
+// their text would miss changed graphics), so all pages count as changed.
+class PDFPageFingerprinter
+{
+public:
+	PDFPageFingerprinter(const QString& fileName) { Q_UNUSED(fileName); }
+	QByteArray fingerprint(int pageIdx) { Q_UNUSED(pageIdx); return QByteArray(); }
+};
+#endif
+
+// Tiles of pages that are unchanged since the previous load of the file are
+// reused. Fingerprints are computed lazily: for a page when one of its tiles
+// is requested, and for the remaining pages when there is nothing to render.
+void PDFRenderer::run()
+{
+	Poppler::Document *document = NULL;
+	quint64 loadedKey = 0, previousKey = 0;
+	PDFPageFingerprinter *fingerprinter = NULL;
+	QVector<QByteArray> fingerprints;	// of the pages of document
+	QBitArray fingerprinted;
+	QHash<QByteArray, int> previousPages;	// fingerprint -> page of the previous load
+	int nextFingerprint = 0;
+
+	forever {
+		PDFPageTile tile;
+		QString name;
+		quint64 key;
+		bool haveTile;
+
+		mutex.lock();
+		forever {
+			haveTile = takeRequest(tile);
+			if (quit || haveTile)
+				break;
+			// fingerprint the remaining pages while there is nothing to render
+			if (fingerprinter != NULL && loadedKey == docKey && nextFingerprint < fingerprints.size())
+				break;
+			requestAvailable.wait(&mutex);
+		}
+		if (quit) {
+			mutex.unlock();
+			break;
+		}
+		name = fileName;
+		key = docKey;
+		mutex.unlock();
+
+		if (haveTile && loadedKey != key) {
+			// remember the fingerprints of the pages of the previous load
+			previousPages.clear();
+			for (int i = 0; i < fingerprints.size(); ++i) {
+				if (!fingerprints[i].isEmpty())
+					previousPages.insert(fingerprints[i], i);
+			}
+			previousKey = loadedKey;
+			delete fingerprinter;
+			fingerprinter = NULL;
+
+			if (document != NULL)
+				delete document;
+			document = Poppler::Document::load(name);
+			if (document != NULL && document->isLocked()) {
+				delete document;
+				document = NULL;
+			}
+			if (document != NULL) {
+				document->setRenderBackend(Poppler::Document::SplashBackend);
+				document->setRenderHint(Poppler::Document::Antialiasing);
+				document->setRenderHint(Poppler::Document::TextAntialiasing);
+				fingerprints = QVector<QByteArray>(document->numPages());
+				fingerprinted = QBitArray(document->numPages());
+#ifdef PDF_PAGE_FINGERPRINTS
+				fingerprinter = new PDFPageFingerprinter(name);
+#endif
+			}
+			else {
+				fingerprints.clear();
+				fingerprinted.clear();
+			}
+			nextFingerprint = 0;
+			loadedKey = key;
+		}
+
+		// computes the fingerprint of a page and takes over the tiles of an
+		// identical page of the previous load
+		int pageIdx = haveTile ? tile.pageIdx : nextFingerprint;
+		if (fingerprinter != NULL && pageIdx >= 0 && pageIdx < fingerprints.size() && !fingerprinted.testBit(pageIdx)) {
+			fingerprints[pageIdx] = fingerprinter->fingerprint(pageIdx);
+			fingerprinted.setBit(pageIdx);
+			if (previousPages.contains(fingerprints[pageIdx])) {
+				PDFPageMapping unchangedPage;
+				unchangedPage.insert(pageIdx, previousPages.value(fingerprints[pageIdx]));
+				PDFRenderCache::instance()->transferPages(previousKey, loadedKey, unchangedPage);
+				emit pagesUnchanged(loadedKey, previousKey, unchangedPage);
+			}
+		}
+		while (nextFingerprint < fingerprinted.size() && fingerprinted.testBit(nextFingerprint))
+			++nextFingerprint;
+
+		if (!haveTile || document == NULL || tile.pageIdx >= document->numPages())
+			continue;
+
+		// the tile may have been carried over from the previous load (or
+		// been rendered for another view) since it was requested
+		QImage cachedImage;
+		if (PDFRenderCache::instance()->lookup(tile, cachedImage, false)) {
+			emit tileRendered(tile, cachedImage);
+			continue;
+		}
+
+		Poppler::Page *page = document->page(tile.pageIdx);
+		if (page == NULL)
+			continue;
+		QImage image = page->renderToImage(tile.dpi, tile.dpi, tile.rect.x(), tile.rect.y(),
+										   tile.rect.width(), tile.rect.height());
+		delete page;
+
+		// nobody is interested in the tile once the renderer is stopped
+		mutex.lock();
+		bool stopped = quit;
+		mutex.unlock();
+		if (!image.isNull() && !stopped) {
+			PDFRenderCache::instance()->insert(tile, image);
+			emit tileRendered(tile, image);
+		}
+	}
+
+	delete fingerprinter;
+	if (document != NULL)
+		delete document;
+}
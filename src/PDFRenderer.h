@@ -0,0 +1,186 @@
+/*
+	This is part of TeXworks, an environment for working with TeX documents
+	Copyright (C) 2007-2012  Jonathan Kew, Stefan Löffler, Charlie Sharpsteen
+
+	This program is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	For links to further information, or to contact the authors,
+	see <http://www.tug.org/texworks/>.
+*/
+
+#ifndef PDFRenderer_H
+#define PDFRenderer_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QImage>
+#include <QRect>
+#include <QList>
+#include <QCache>
+#include <QMetaType>
+#include <QHash>
+#include <QVector>
+#include <QByteArray>
+
+#include "poppler-qt4.h"
+
+// edge length (in pixels) of the square tiles pages are split into for rendering
+const int kPDFTileSize = 256;
+
+// A rectangular piece of a rendered page. The rect is given in device pixels
+// at the given resolution, i.e., relative to the top left corner of the page
+// rendered at dpi. docKey identifies one particular load of a PDF file (it
+// changes on every reload), so tiles of outdated documents never match.
+class PDFPageTile
+{
+public:
+	PDFPageTile(quint64 doc = 0, int page = -1, qreal res = 0, const QRect& r = QRect())
+		: docKey(doc), pageIdx(page), dpi(res), rect(r)
+		{ }
+
+	bool isNull() const { return pageIdx < 0; }
+
+	bool operator==(const PDFPageTile& other) const
+		{
+			return docKey == other.docKey && pageIdx == other.pageIdx &&
+					dpi == other.dpi && rect == other.rect;
+		}
+	bool operator!=(const PDFPageTile& other) const { return !(*this == other); }
+
+	quint64	docKey;
+	int		pageIdx;
+	qreal	dpi;
+	QRect	rect;
+};
+
+uint qHash(const PDFPageTile& tile);
+
+Q_DECLARE_METATYPE(PDFPageTile)
+
+// maps page indices of a newly loaded document to the indices of identical
+// pages in the previous load of the same file
+typedef QHash<int, int> PDFPageMapping;
+
+Q_DECLARE_METATYPE(PDFPageMapping)
+
+// default memory budget for rendered tiles (in MB); can be changed using the
+// "pdfRenderCacheSize" setting
+const int kDefault_RenderCacheSize = 128;
+
+// Process-wide LRU cache of rendered tiles, shared by all PDF windows.
+// Tiles are inserted by the render threads, so all access is serialized.
+class PDFRenderCache
+{
+public:
+	static PDFRenderCache *instance();
+
+	// returns true and sets image if the tile is in the cache; only lookups
+	// with countStatistics set are reflected in hits() and misses()
+	bool lookup(const PDFPageTile& tile, QImage& image, bool countStatistics = true);
+	bool contains(const PDFPageTile& tile) const;
+	void insert(const PDFPageTile& tile, const QImage& image);
+
+	// drop all tiles belonging to the given document load
+	void invalidate(quint64 docKey);
+	// move the tiles of unchanged pages from one document load to the next
+	void transferPages(quint64 fromDocKey, quint64 toDocKey, const PDFPageMapping& pages);
+	void clear();
+
+	void setMaxSize(int megabytes);
+	int maxSize() const;
+
+	int hits() const { return hitCount; }
+	int misses() const { return missCount; }
+	void resetStatistics();
+
+private:
+	PDFRenderCache();
+
+	mutable QMutex	mutex;
+	QCache<PDFPageTile, QImage>	cache;	// cost is measured in kB
+	int	hitCount;
+	int	missCount;
+
+	static PDFRenderCache	*theInstance;
+};
+
+// Background renderer for one PDF file. Rendered tiles are put into the
+// PDFRenderCache before tileRendered() is emitted.
+// Poppler documents must not be used from several threads at the same time,
+// so the render thread works on its own Poppler::Document instance, loaded
+// from the same file as the one used in the GUI thread. Requests are grouped
+// in channels; a new request on a channel replaces everything still pending
+// on that channel (so tiles that scrolled out of view are never rendered).
+// Lower channel numbers are served first.
+// When a new version of the file is loaded, pages whose content did not
+// change are detected by their fingerprints and keep their rendered tiles
+// (this requires poppler's xpdf headers; otherwise all pages are rendered
+// anew).
+class PDFRenderer : public QThread
+{
+	Q_OBJECT
+
+public:
+	typedef enum {
+		kPlaceholderChannel = 0,	// low-resolution previews of the current page
+		kMagnifierChannel,			// magnified tiles around the magnifier
+		kViewChannel,				// tiles visible in the main view
+		kThumbnailChannel,			// thumbnails in view in the thumbnail dock
+		kPrefetchChannel,			// neighbouring pages likely to be viewed next
+		kNumChannels
+	} Channel;
+
+	PDFRenderer(QObject *parent = NULL);
+	// waits for a render in progress to finish
+	virtual ~PDFRenderer();
+
+	// makes the render thread quit (once it is done with the current tile)
+	// without waiting for it
+	void stop();
+
+	// (re)load the file in the render thread; returns the key identifying
+	// tiles of the new document
+	quint64 setFileName(const QString& fileName);
+	quint64 documentKey() const { return docKey; }
+
+	void requestTiles(Channel channel, const QList<PDFPageTile>& tiles);
+	void cancelRequests(Channel channel);
+	void cancelAllRequests();
+
+signals:
+	// emitted from the render thread; connections to GUI objects are queued
+	void tileRendered(const PDFPageTile& tile, const QImage& image);
+	// emitted from the render thread after a reload; unchangedPages maps
+	// pages of docKey to the identical ones of previousDocKey
+	void pagesUnchanged(quint64 docKey, quint64 previousDocKey, const PDFPageMapping& unchangedPages);
+
+protected:
+	virtual void run();
+
+private:
+	bool takeRequest(PDFPageTile& tile);
+
+	QMutex			mutex;
+	QWaitCondition	requestAvailable;
+	QList<PDFPageTile>	pending[kNumChannels];
+
+	QString	fileName;
+	quint64	docKey;
+	bool	quit;
+
+	static quint64	lastDocKey;
+};
+
+#endif
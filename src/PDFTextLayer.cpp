@@ -0,0 +1,232 @@
+/*
+	This is part of TeXworks, an environment for working with TeX documents
+	Copyright (C) 2007-2012  Jonathan Kew, Stefan Löffler, Charlie Sharpsteen
+
+	This program is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	For links to further information, or to contact the authors,
+	see <http://www.tug.org/texworks/>.
+*/
+
+#include "PDFTextLayer.h"
+
+#include <QtConcurrentMap>
+
+#pragma mark === PDFTextPage ===
+
+PDFTextPage PDFTextPage::extract(Poppler::Page *page, int index)
+{
+	PDFTextPage result(index);
+	foreach (Poppler::TextBox *box, page->textList()) {
+		QString word = box->text();
+		for (int i = 0; i < word.length(); ++i) {
+			result.text += word[i];
+			result.charBoxes << box->charBoundingBox(i);
+		}
+		// treat the end of a line like a space between words
+		if (box->hasSpaceAfter() || box->nextWord() == NULL) {
+			result.text += QChar(' ');
+			result.charBoxes << QRectF();
+		}
+		delete box;
+	}
+	return result;
+}
+
+QList<PDFTextMatch> PDFTextPage::search(const QString& searchText, Qt::CaseSensitivity cs) const
+{
+	QList<PDFTextMatch> result;
+	if (searchText.isEmpty())
+		return result;
+	int pos = 0;
+	while ((pos = text.indexOf(searchText, pos, cs)) >= 0) {
+		QRectF r;
+		for (int i = pos; i < pos + searchText.length(); ++i)
+			r |= charBoxes[i];
+		result << PDFTextMatch(pageIdx, pos, searchText.length(), r);
+		pos += searchText.length();
+	}
+	return result;
+}
+
+QString PDFTextPage::context(const PDFTextMatch& match, int charsBefore, int charsAfter) const
+{
+	int start = qMax(0, match.start - charsBefore);
+	int end = qMin(text.length(), match.start + match.length + charsAfter);
+	QString result = text.mid(start, end - start).trimmed();
+	if (start > 0)
+		result.prepend(QObject::tr("..."));
+	if (end < text.length())
+		result.append(QObject::tr("..."));
+	return result;
+}
+
+#pragma mark === PDFTextLayer ===
+
+// a range of pages to be extracted by one worker
+class PDFTextChunk
+{
+public:
+	PDFTextChunk(const QString& name = QString()) : fileName(name) { }
+	QString		fileName;
+	QList<int>	pageIndices;
+};
+
+static QList<PDFTextPage> extractChunk(const PDFTextChunk& chunk)
+{
+	QList<PDFTextPage> result;
+	Poppler::Document *doc = Poppler::Document::load(chunk.fileName);
+	if (doc == NULL)
+		return result;
+	if (!doc->isLocked()) {
+		foreach (int index, chunk.pageIndices) {
+			Poppler::Page *page = doc->page(index);
+			if (page != NULL) {
+				result << PDFTextPage::extract(page, index);
+				delete page;
+			}
+		}
+	}
+	delete doc;
+	return result;
+}
+
+// pages per chunk; small enough for results to come in steadily, large
+// enough for the cost of loading the document in each worker not to matter
+const int kPagesPerTextChunk = 16;
+
+PDFTextLayer::PDFTextLayer(QObject *parent)
+	: QObject(parent)
+	, docKey(0)
+	, extractedCount(0)
+	, previousDocKey(0)
+	, extractor(NULL)
+{
+}
+
+PDFTextLayer::~PDFTextLayer()
+{
+	if (extractor != NULL)
+		extractor->cancel();
+}
+
+void PDFTextLayer::setDocument(const QString& name, int numPages, quint64 key)
+{
+	if (extractor != NULL) {
+		// results of the running extraction are of no use anymore
+		extractor->cancel();
+		extractor->disconnect(this);
+		extractor->deleteLater();
+		extractor = NULL;
+	}
+	previousDocKey = docKey;
+	previousPages = pages;
+	for (int i = 0; i < previousPages.size(); ++i) {
+		if (!available[i])
+			previousPages[i] = PDFTextPage();
+	}
+
+	fileName = name;
+	docKey = key;
+	pages = QVector<PDFTextPage>(numPages);
+	available = QVector<bool>(numPages, false);
+	extractedCount = 0;
+}
+
+void PDFTextLayer::reusePages(quint64 key, quint64 prevKey, const PDFPageMapping& unchangedPages)
+{
+	if (key != docKey || prevKey != previousDocKey)
+		return;
+	foreach (int index, unchangedPages.keys()) {
+		int oldIndex = unchangedPages.value(index);
+		if (index >= pages.size() || oldIndex >= previousPages.size() || previousPages[oldIndex].pageIdx < 0 || hasPage(index))
+			continue;
+		PDFTextPage textPage = previousPages[oldIndex];
+		textPage.pageIdx = index;
+		setPage(textPage);
+	}
+	// unchanged pages are reported as the renderer finds them, so the
+	// previous pages are kept until the next load
+	if (isComplete())
+		emit extractionFinished();
+}
+
+void PDFTextLayer::extract()
+{
+	if (extractor != NULL || isComplete())
+		return;
+
+	QList<PDFTextChunk> chunks;
+	PDFTextChunk chunk(fileName);
+	for (int i = 0; i < pages.size(); ++i) {
+		if (available[i])
+			continue;
+		chunk.pageIndices << i;
+		if (chunk.pageIndices.size() == kPagesPerTextChunk) {
+			chunks << chunk;
+			chunk.pageIndices.clear();
+		}
+	}
+	if (!chunk.pageIndices.isEmpty())
+		chunks << chunk;
+
+	extractor = new QFutureWatcher< QList<PDFTextPage> >(this);
+	connect(extractor, SIGNAL(resultReadyAt(int)), this, SLOT(chunkExtracted(int)));
+	connect(extractor, SIGNAL(finished()), this, SLOT(extractorFinished()));
+	extractor->setFuture(QtConcurrent::mapped(chunks, extractChunk));
+}
+
+void PDFTextLayer::chunkExtracted(int resultIndex)
+{
+	foreach (const PDFTextPage& textPage, extractor->resultAt(resultIndex)) {
+		if (!hasPage(textPage.pageIdx)) {
+			setPage(textPage);
+			emit pageExtracted(textPage.pageIdx);
+		}
+	}
+}
+
+void PDFTextLayer::extractorFinished()
+{
+	extractor->deleteLater();
+	extractor = NULL;
+	// pages that failed to load are left out, so searches can complete
+	for (int i = 0; i < pages.size(); ++i) {
+		if (!available[i])
+			setPage(PDFTextPage(i));
+	}
+	emit extractionFinished();
+}
+
+void PDFTextLayer::setPage(const PDFTextPage& textPage)
+{
+	int index = textPage.pageIdx;
+	if (index < 0 || index >= pages.size())
+		return;
+	pages[index] = textPage;
+	if (!available[index]) {
+		available[index] = true;
+		++extractedCount;
+	}
+}
+
+QList<PDFTextPage> PDFTextLayer::availablePages() const
+{
+	QList<PDFTextPage> result;
+	for (int i = 0; i < pages.size(); ++i) {
+		if (available[i])
+			result << pages[i];
+	}
+	return result;
+}
@@ -0,0 +1,138 @@
+/*
+	This is part of TeXworks, an environment for working with TeX documents
+	Copyright (C) 2007-2012  Jonathan Kew, Stefan Löffler, Charlie Sharpsteen
+
+	This program is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	For links to further information, or to contact the authors,
+	see <http://www.tug.org/texworks/>.
+*/
+
+#ifndef PDFTextLayer_H
+#define PDFTextLayer_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QList>
+#include <QRectF>
+#include <QFutureWatcher>
+
+#include "PDFRenderer.h"
+
+// A match of a search in the text of a page; start and length refer to
+// PDFTextPage::text, rect (in points) covers all characters of the match
+class PDFTextMatch
+{
+public:
+	PDFTextMatch(int page = -1, int matchStart = 0, int matchLength = 0, const QRectF& r = QRectF())
+		: pageIdx(page), start(matchStart), length(matchLength), rect(r)
+		{ }
+
+	int		pageIdx;
+	int		start;
+	int		length;
+	QRectF	rect;
+};
+
+// The text of one page with the bounding box (in points) of each character.
+// Words are separated by single spaces, including at line breaks, so phrases
+// are found across lines.
+class PDFTextPage
+{
+public:
+	PDFTextPage(int page = -1) : pageIdx(page) { }
+
+	static PDFTextPage extract(Poppler::Page *page, int index);
+
+	QList<PDFTextMatch> search(const QString& searchText, Qt::CaseSensitivity cs) const;
+	// the text around a match, for presenting search results
+	QString context(const PDFTextMatch& match, int charsBefore, int charsAfter) const;
+
+	int		pageIdx;
+	QString	text;
+	QVector<QRectF>	charBoxes;
+};
+
+// Searches one page; used with QtConcurrent::mapped
+class PDFTextSearch
+{
+public:
+	typedef QList<PDFTextMatch> result_type;
+
+	PDFTextSearch(const QString& text, Qt::CaseSensitivity caseSensitivity)
+		: searchText(text), cs(caseSensitivity)
+		{ }
+
+	result_type operator()(const PDFTextPage& page) const { return page.search(searchText, cs); }
+
+private:
+	QString	searchText;
+	Qt::CaseSensitivity	cs;
+};
+
+// Text of all pages of a document, extracted in the background. The pages
+// are split into chunks that are extracted in parallel, each worker using
+// its own Poppler::Document (as documents are not thread-safe). Pages that
+// didn't change in a reload keep their text.
+class PDFTextLayer : public QObject
+{
+	Q_OBJECT
+
+public:
+	PDFTextLayer(QObject *parent = NULL);
+	virtual ~PDFTextLayer();
+
+	// forget the current text and prepare for a new load of fileName
+	void setDocument(const QString& fileName, int numPages, quint64 docKey);
+
+	// start extracting all pages that are not available yet
+	void extract();
+
+	int numPages() const { return pages.size(); }
+	bool hasPage(int index) const { return index >= 0 && index < available.size() && available[index]; }
+	bool isComplete() const { return extractedCount == pages.size(); }
+	const PDFTextPage& page(int index) const { return pages[index]; }
+	// all pages available so far
+	QList<PDFTextPage> availablePages() const;
+
+public slots:
+	// connected to PDFRenderer::pagesUnchanged()
+	void reusePages(quint64 docKey, quint64 previousDocKey, const PDFPageMapping& unchangedPages);
+
+signals:
+	void pageExtracted(int index);
+	void extractionFinished();
+
+private slots:
+	void chunkExtracted(int resultIndex);
+	void extractorFinished();
+
+private:
+	void setPage(const PDFTextPage& textPage);
+
+	QString	fileName;
+	quint64	docKey;
+	QVector<PDFTextPage>	pages;
+	QVector<bool>	available;
+	int		extractedCount;
+
+	// the text of the previous load, kept until the unchanged pages are known
+	quint64	previousDocKey;
+	QVector<PDFTextPage>	previousPages;
+
+	QFutureWatcher< QList<PDFTextPage> >	*extractor;
+};
+
+#endif
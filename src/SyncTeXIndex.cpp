@@ -0,0 +1,1397 @@
+/*
+	This is part of TeXworks, an environment for working with TeX documents
+	Copyright (C) 2007-2012  Jonathan Kew, Stefan Löffler, Charlie Sharpsteen
+
+	This program is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	For links to further information, or to contact the authors,
+	see <http://www.tug.org/texworks/>.
+*/
+
+
+#include "SyncTeXIndex.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QStringList>
+#include <QSet>
+#include <QMutexLocker>
+#include <QTemporaryFile>
+#include <QtAlgorithms>
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include <zlib.h>
+
+#define SYNCTEX_GZ_EXT	".synctex.gz"
+#define SYNCTEX_EXT		".synctex"
+#define SYNCTEX_INDEX_EXT	".synctex.index"
+
+// SyncTeX files are read in chunks of this size (in bytes)
+const int kReadBufferSize = 64 * 1024;
+// amount of decompressed data (in bytes) between two checkpoints
+const qint64 kCheckpointSpan = 1024 * 1024;
+// deflate refers back at most this far (in bytes)
+const int kDeflateWindowSize = 32 * 1024;
+
+#pragma mark === SyncTeXStream ===
+
+// Reads the decompressed contents of a .synctex(.gz) file line by line.
+// Uncompressed files are read as they are. For compressed ones, the stream
+// can record checkpoints while reading through the file, and use them later
+// to continue at an arbitrary offset without decompressing everything before.
+class SyncTeXStream
+{
+public:
+	SyncTeXStream(const QString& fileName, QVector<SyncTeXCheckpoint> *checkpointsToRecord = NULL);
+	~SyncTeXStream();
+
+	// continues reading at the given offset in the decompressed data
+	bool seek(qint64 offset, const QVector<SyncTeXCheckpoint>& checkpoints);
+
+	// returns the next line without its line break, or NULL at the end of
+	// the file; the pointer is valid until the next call
+	const char *nextLine();
+	// the offset of the line returned last in the decompressed data
+	qint64 lineOffset() const { return lastLineOffset; }
+
+private:
+	bool restart(const SyncTeXCheckpoint *checkpoint);
+	int read(char *dest, int maxSize);
+
+	QFile	file;
+	bool	ok;
+	bool	compressed;
+	z_stream	zStream;
+	bool	zStreamInitialized;
+	bool	zStreamEnd;
+	QByteArray	input;
+	qint64	position;	// of the next byte read() returns
+	QVector<SyncTeXCheckpoint>	*newCheckpoints;
+	QByteArray	history;	// recently decompressed data, for checkpoints
+
+	QByteArray	buffer;
+	int		start;
+	int		end;
+	bool	atEnd;
+	qint64	bufferOffset;	// of buffer[0]
+	qint64	lastLineOffset;
+};
+
+SyncTeXStream::SyncTeXStream(const QString& fileName, QVector<SyncTeXCheckpoint> *checkpointsToRecord)
+	: file(fileName), ok(false), compressed(false), zStreamInitialized(false), zStreamEnd(false)
+	, position(0), newCheckpoints(checkpointsToRecord)
+	, start(0), end(0), atEnd(false), bufferOffset(0), lastLineOffset(0)
+{
+	buffer.resize(kReadBufferSize + 1);
+	input.resize(kReadBufferSize);
+	if (!file.open(QIODevice::ReadOnly))
+		return;
+	QByteArray magic = file.peek(2);
+	compressed = (magic.size() == 2 && (uchar)magic[0] == 0x1f && (uchar)magic[1] == 0x8b);
+	ok = !compressed || restart(NULL);
+}
+
+SyncTeXStream::~SyncTeXStream()
+{
+	if (zStreamInitialized)
+		inflateEnd(&zStream);
+}
+
+// (re)starts decompression at the beginning of the file or at a checkpoint
+bool SyncTeXStream::restart(const SyncTeXCheckpoint *checkpoint)
+{
+	if (zStreamInitialized) {
+		inflateEnd(&zStream);
+		zStreamInitialized = false;
+	}
+	memset(&zStream, 0, sizeof(zStream));
+	zStreamEnd = false;
+	history.clear();
+
+	if (checkpoint == NULL) {
+		// 15 + 32: the default window size, with a gzip header
+		if (!file.seek(0) || inflateInit2(&zStream, 15 + 32) != Z_OK)
+			return false;
+		position = 0;
+	}
+	else {
+		// checkpoints are inside the raw deflate data
+		if (!file.seek(checkpoint->compressedOffset - (checkpoint->bits > 0 ? 1 : 0)))
+			return false;
+		if (inflateInit2(&zStream, -15) != Z_OK)
+			return false;
+		if (checkpoint->bits > 0) {
+			char c;
+			if (!file.getChar(&c)) {
+				inflateEnd(&zStream);
+				return false;
+			}
+			inflatePrime(&zStream, checkpoint->bits, (uchar)c >> (8 - checkpoint->bits));
+		}
+		inflateSetDictionary(&zStream, (const Bytef*)checkpoint->window.constData(), checkpoint->window.size());
+		position = checkpoint->offset;
+	}
+	zStreamInitialized = true;
+	return true;
+}
+
+int SyncTeXStream::read(char *dest, int maxSize)
+{
+	if (!compressed) {
+		qint64 bytesRead = file.read(dest, maxSize);
+		if (bytesRead <= 0)
+			return 0;
+		position += bytesRead;
+		return bytesRead;
+	}
+
+	int produced = 0;
+	while (produced < maxSize && !zStreamEnd) {
+		if (zStream.avail_in == 0) {
+			qint64 bytesRead = file.read(input.data(), input.size());
+			if (bytesRead <= 0)
+				break;
+			zStream.next_in = (Bytef*)input.data();
+			zStream.avail_in = bytesRead;
+		}
+		zStream.next_out = (Bytef*)dest + produced;
+		zStream.avail_out = maxSize - produced;
+		// Z_BLOCK stops at the end of each deflate block, where checkpoints
+		// can be set
+		int result = inflate(&zStream, Z_BLOCK);
+		int bytes = maxSize - produced - zStream.avail_out;
+		if (newCheckpoints != NULL && bytes > 0) {
+			history.append(dest + produced, bytes);
+			if (history.size() > 2 * kDeflateWindowSize)
+				history.remove(0, history.size() - kDeflateWindowSize);
+		}
+		produced += bytes;
+		position += bytes;
+
+		if (result == Z_STREAM_END)
+			zStreamEnd = true;
+		else if (result != Z_OK && !(result == Z_BUF_ERROR && zStream.avail_in == 0))
+			break;	// corrupt data
+		else if (newCheckpoints != NULL && (zStream.data_type & 128) && !(zStream.data_type & 64)) {
+			// at the end of a block that is not the last one
+			qint64 lastOffset = (newCheckpoints->isEmpty() ? 0 : newCheckpoints->last().offset);
+			if (position - lastOffset > kCheckpointSpan)
+				*newCheckpoints << SyncTeXCheckpoint(file.pos() - zStream.avail_in, zStream.data_type & 7,
+													 position, history.right(kDeflateWindowSize));
+		}
+	}
+	return produced;
+}
+
+bool SyncTeXStream::seek(qint64 offset, const QVector<SyncTeXCheckpoint>& checkpoints)
+{
+	if (!ok)
+		return false;
+	if (offset >= bufferOffset + start && offset <= bufferOffset + end) {
+		// already read, but not returned yet
+		start = offset - bufferOffset;
+		return true;
+	}
+	if (!compressed) {
+		if (!file.seek(offset))
+			return false;
+		position = offset;
+	}
+	else {
+		// resume at the closest checkpoint, unless reading on is quicker
+		const SyncTeXCheckpoint *checkpoint = NULL;
+		for (int i = 0; i < checkpoints.size() && checkpoints[i].offset <= offset; ++i)
+			checkpoint = &checkpoints[i];
+		if (offset < position || (checkpoint != NULL && checkpoint->offset > position)) {
+			if (!restart(checkpoint))
+				return (ok = false);
+		}
+		while (position < offset) {
+			if (read(buffer.data(), qMin<qint64>(buffer.size() - 1, offset - position)) <= 0)
+				return false;
+		}
+	}
+	start = end = 0;
+	atEnd = false;
+	bufferOffset = position;
+	return true;
+}
+
+const char *SyncTeXStream::nextLine()
+{
+	if (!ok)
+		return NULL;
+	char *data = buffer.data();
+	while (true) {
+		char *lineEnd = (char*)memchr(data + start, '\n', end - start);
+		if (lineEnd != NULL) {
+			*lineEnd = '\0';
+			const char *line = data + start;
+			lastLineOffset = bufferOffset + start;
+			start = lineEnd - data + 1;
+			return line;
+		}
+		if (atEnd) {
+			if (start >= end)
+				return NULL;
+			// last line without a line break
+			data[end] = '\0';
+			const char *line = data + start;
+			lastLineOffset = bufferOffset + start;
+			start = end;
+			return line;
+		}
+		// move the incomplete line to the front and read more
+		memmove(data, data + start, end - start);
+		bufferOffset += start;
+		end -= start;
+		start = 0;
+		if (end == buffer.size() - 1) {
+			buffer.resize(2 * buffer.size() - 1);
+			data = buffer.data();
+		}
+		int bytesRead = read(data + end, buffer.size() - 1 - end);
+		if (bytesRead <= 0)
+			atEnd = true;
+		else
+			end += bytesRead;
+	}
+}
+
+#pragma mark === helpers ===
+
+static bool startsWith(const char *line, const char *prefix)
+{
+	return strncmp(line, prefix, strlen(prefix)) == 0;
+}
+
+// reads count integers separated by ',' or ':'
+static bool decodeIntegers(const char *p, qint32 *values, int count)
+{
+	for (int i = 0; i < count; ++i) {
+		if (*p == ',' || *p == ':')
+			++p;
+		char *numberEnd;
+		long value = strtol(p, &numberEnd, 10);
+		if (numberEnd == p)
+			return false;
+		values[i] = value;
+		p = numberEnd;
+	}
+	return true;
+}
+
+// reads a TeX dimension like "1in" or "-72.27pt" and returns it in sp
+static bool decodeDimension(const char *p, double& value)
+{
+	while (*p == ' ')
+		++p;
+	const char *numberEnd = p;
+	while (*numberEnd == '+' || *numberEnd == '-' || *numberEnd == '.' || (*numberEnd >= '0' && *numberEnd <= '9'))
+		++numberEnd;
+	bool ok;
+	value = QByteArray(p, numberEnd - p).toDouble(&ok);
+	if (!ok)
+		return false;
+
+	static const struct {
+		const char *name;
+		double factor;
+	} units[] = {
+		{ "in", 72.27 * 65536 },
+		{ "cm", 72.27 * 65536 / 2.54 },
+		{ "mm", 72.27 * 65536 / 25.4 },
+		{ "pt", 65536 },
+		{ "bp", 72.27 / 72 * 65536 },
+		{ "pc", 12 * 65536 },
+		{ "sp", 1 },
+		{ "dd", 1238.0 / 1157 * 65536 },
+		{ "cc", 14856.0 / 1157 * 65536 },
+		{ "nd", 685.0 / 642 * 65536 },
+		{ "nc", 1370.0 / 107 * 65536 }
+	};
+	for (unsigned int i = 0; i < sizeof(units) / sizeof(units[0]); ++i) {
+		if (startsWith(numberEnd, units[i].name)) {
+			value *= units[i].factor;
+			break;
+		}
+	}
+	return true;
+}
+
+static QString findSyncTeXFile(const QString& pdfFileName)
+{
+	QFileInfo fi(pdfFileName);
+	QDir dir(fi.absoluteDir());
+	QStringList baseNames;
+	// names containing spaces are quoted by TeX
+	baseNames << fi.completeBaseName() << "\"" + fi.completeBaseName() + "\"";
+	foreach (const QString& baseName, baseNames) {
+		QString path = dir.absoluteFilePath(baseName + SYNCTEX_GZ_EXT);
+		if (QFileInfo(path).exists())
+			return path;
+		path = dir.absoluteFilePath(baseName + SYNCTEX_EXT);
+		if (QFileInfo(path).exists())
+			return path;
+	}
+	return QString();
+}
+
+static QString findIndexFile(const QString& pdfFileName)
+{
+	QFileInfo fi(pdfFileName);
+	return fi.absoluteDir().absoluteFilePath(fi.completeBaseName() + SYNCTEX_INDEX_EXT);
+}
+
+// checksum of the end of a file; for .synctex.gz files, this includes the
+// CRC of all the data
+static quint32 fileHash(const QString& fileName)
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly))
+		return 0;
+	file.seek(qMax<qint64>(0, file.size() - 4096));
+	QByteArray tail = file.readAll();
+	return crc32(0, (const Bytef*)tail.constData(), tail.size());
+}
+
+static bool isRecord(char c)
+{
+	return strchr("[(vhkg$x", c) != NULL && c != '\0';
+}
+
+#pragma mark === SyncTeXIndex ===
+
+SyncTeXIndex::SyncTeXIndex(const QString& fileName)
+	: synctexFile(fileName), fileSize(0)
+	, sheetOffsetData(NULL), numSheets(0), lineLocationData(NULL), numLineLocations(0)
+	, loadedPages(kMaxLoadedSyncTeXRecords), unit(0), xOffset(0), yOffset(0)
+{
+	QFileInfo fi(fileName);
+	fileSize = fi.size();
+	fileModified = fi.lastModified();
+}
+
+SyncTeXIndexPointer SyncTeXIndex::load(const QString& pdfFileName)
+{
+	QString fileName = findSyncTeXFile(pdfFileName);
+	if (fileName.isEmpty())
+		return SyncTeXIndexPointer();
+
+	SyncTeXIndexPointer index(new SyncTeXIndex(fileName));
+	QString indexFileName = findIndexFile(pdfFileName);
+	if (index->mapIndexFile(indexFileName))
+		return index;
+
+	SyncTeXStream stream(fileName, &index->checkpoints);
+	if (!index->scan(stream))
+		return SyncTeXIndexPointer();
+	index->writeIndexFile(indexFileName);
+	return index;
+}
+
+bool SyncTeXIndex::scan(SyncTeXStream& stream)
+{
+	int preUnit = 8192;
+	int preMagnification = 1000;
+	int preXOffset = 578;
+	int preYOffset = 578;
+	const char *line;
+
+	// preamble
+	bool hasContent = false;
+	while ((line = stream.nextLine()) != NULL) {
+		if (startsWith(line, "Input:"))
+			parseInput(line + 6);
+		else if (startsWith(line, "Magnification:"))
+			preMagnification = atoi(line + 14);
+		else if (startsWith(line, "Unit:"))
+			preUnit = atoi(line + 5);
+		else if (startsWith(line, "X Offset:"))
+			preXOffset = atoi(line + 9);
+		else if (startsWith(line, "Y Offset:"))
+			preYOffset = atoi(line + 9);
+		else if (startsWith(line, "Content:")) {
+			hasContent = true;
+			break;
+		}
+	}
+	if (!hasContent)
+		return false;
+
+	// content; only the location of the sheets and the lines they show are
+	// noted here
+	int pageIdx = -1;
+	int nestedSheets = 0;
+	QVector<LineLocation> sheetLines;
+	LineLocation boxLocation = { 0, 0, 0, 0 };
+	bool openedBox = false;
+	while ((line = stream.nextLine()) != NULL) {
+		if (*line == '{') {
+			if (pageIdx >= 0)
+				++nestedSheets;
+			else {
+				int pageNo = atoi(line + 1);
+				if (pageNo > 0) {
+					while (sheetOffsets.size() < pageNo)
+						sheetOffsets << -1;
+					pageIdx = pageNo - 1;
+					sheetOffsets[pageIdx] = stream.lineOffset();
+				}
+			}
+		}
+		else if (*line == '}') {
+			if (nestedSheets > 0)
+				--nestedSheets;
+			else if (pageIdx >= 0) {
+				addLineLocations(sheetLines);
+				pageIdx = -1;
+			}
+		}
+		else if (startsWith(line, "Input:"))
+			parseInput(line + 6);
+		else if (pageIdx >= 0 && nestedSheets == 0) {
+			// boxes are only shown for their own line if they are empty (as in
+			// addRecord()), i.e., if they are closed right after being opened
+			if (*line == ']' || *line == ')') {
+				if (openedBox)
+					sheetLines << boxLocation;
+				openedBox = false;
+				continue;
+			}
+			qint32 values[2];
+			if (!isRecord(*line))
+				continue;
+			openedBox = false;
+			if (!decodeIntegers(line + 1, values, 2))
+				continue;
+			LineLocation location = { values[0], values[1], pageIdx, displayPriority(recordType(*line)) };
+			if (*line == '[' || *line == '(') {
+				boxLocation = location;
+				openedBox = true;
+			}
+			else if (!sheetLines.isEmpty() && sheetLines.last() == location)
+				sheetLines.last().priority = qMin(sheetLines.last().priority, location.priority);
+			else
+				sheetLines << location;
+		}
+		else if (startsWith(line, "Postamble:"))
+			break;
+	}
+	qSort(lineLocations);
+	lineLocations.squeeze();
+	sheetOffsetData = sheetOffsets.constData();
+	numSheets = sheetOffsets.size();
+	lineLocationData = lineLocations.constData();
+	numLineLocations = lineLocations.size();
+
+	// postamble
+	double postMagnification = 0;
+	double postXOffset = 0, postYOffset = 0;
+	bool hasPostOffset = false;
+	while ((line = stream.nextLine()) != NULL) {
+		if (startsWith(line, "Magnification:"))
+			postMagnification = QByteArray(line + 14).trimmed().toDouble();
+		else if (startsWith(line, "X Offset:"))
+			hasPostOffset = decodeDimension(line + 9, postXOffset);
+		else if (startsWith(line, "Y Offset:"))
+			hasPostOffset = decodeDimension(line + 9, postYOffset) && hasPostOffset;
+	}
+
+	// 1 unit of the file is preUnit sp, and 65781.76 sp make 1 bp
+	if (preUnit <= 0)
+		preUnit = 8192;
+	if (preMagnification <= 0)
+		preMagnification = 1000;
+	unit = preUnit / 65781.76;
+	if (postMagnification > 0)
+		unit *= postMagnification;
+	unit *= preMagnification / 1000.0;
+	if (hasPostOffset) {
+		xOffset = postXOffset / 65781.76;
+		yOffset = postYOffset / 65781.76;
+	}
+	else {
+		xOffset = preXOffset * (preUnit / 65781.76);
+		yOffset = preYOffset * (preUnit / 65781.76);
+	}
+	return true;
+}
+
+void SyncTeXIndex::parseInput(const char *line)
+{
+	char *nameStart;
+	long tag = strtol(line, &nameStart, 10);
+	if (nameStart == line || *nameStart != ':')
+		return;
+	inputNames.insert(tag, QString::fromUtf8(nameStart + 1));
+}
+
+// adds the distinct entries of locations (which all belong to one sheet),
+// each with the best priority of its duplicates
+void SyncTeXIndex::addLineLocations(QVector<LineLocation>& locations)
+{
+	qSort(locations);
+	for (int i = 0; i < locations.size(); ++i) {
+		if (i > 0 && locations[i] == lineLocations.last())
+			lineLocations.last().priority = qMin(lineLocations.last().priority, locations[i].priority);
+		else
+			lineLocations << locations[i];
+	}
+	locations.clear();
+}
+
+bool SyncTeXIndex::LineLocation::operator<(const LineLocation& other) const
+{
+	if (tag != other.tag)
+		return tag < other.tag;
+	if (line != other.line)
+		return line < other.line;
+	return pageIdx < other.pageIdx;
+}
+
+bool SyncTeXIndex::fileUnchanged() const
+{
+	QFileInfo fi(synctexFile);
+	return fi.size() == fileSize && fi.lastModified() == fileModified;
+}
+
+#pragma mark === index files ===
+
+// Layout of the index files: the header is followed by the sheet offsets,
+// the line locations, the checkpoints (with their windows) and the inputs,
+// each starting at a multiple of 8 bytes. Numbers are stored in the byte order
+// of the machine that wrote the file.
+const char kIndexFileMagic[8] = { 'T', 'W', 'S', 'Y', 'N', 'C', 'I', 'X' };
+const quint32 kIndexFileByteOrder = 0x01020304;
+// must be increased whenever the layout or the meaning of the data changes
+const quint32 kIndexFileVersion = 3;
+
+class SyncTeXIndexFileHeader
+{
+public:
+	char	magic[8];
+	quint32	byteOrder;
+	quint32	version;
+	// the SyncTeX file the index was made from
+	qint64	synctexSize;
+	qint64	synctexModified;	// seconds since the epoch
+	quint32	synctexHash;
+	qint32	numSheets;
+	qint32	numLineLocations;
+	qint32	numCheckpoints;
+	qint32	numInputs;
+	qint32	reserved;
+	double	unit;
+	double	xOffset;
+	double	yOffset;
+	qint64	sheetsStart;
+	qint64	lineLocationsStart;
+	qint64	checkpointsStart;
+	qint64	inputsStart;
+};
+
+class SyncTeXIndexFileCheckpoint
+{
+public:
+	qint64	compressedOffset;
+	qint64	offset;
+	qint64	windowStart;
+	qint32	bits;
+	qint32	windowSize;
+};
+
+static void appendData(QByteArray& data, const void *values, int size)
+{
+	data.append((const char*)values, size);
+}
+
+static void alignData(QByteArray& data)
+{
+	while (data.size() % 8 != 0)
+		data.append('\0');
+}
+
+// checks that count items of the given size starting at start are inside the file
+static bool validRange(qint64 start, qint64 count, qint64 itemSize, qint64 fileSize)
+{
+	return start >= 0 && count >= 0 && start + count * itemSize <= fileSize;
+}
+
+bool SyncTeXIndex::mapIndexFile(const QString& indexFileName)
+{
+	indexFile.setFileName(indexFileName);
+	if (!indexFile.open(QIODevice::ReadOnly))
+		return false;
+	const qint64 size = indexFile.size();
+	const uchar *data = (size >= (qint64)sizeof(SyncTeXIndexFileHeader) ? indexFile.map(0, size) : NULL);
+	if (data == NULL) {
+		indexFile.close();
+		return false;
+	}
+
+	const SyncTeXIndexFileHeader *header = (const SyncTeXIndexFileHeader*)data;
+	bool valid = memcmp(header->magic, kIndexFileMagic, sizeof(kIndexFileMagic)) == 0 &&
+			header->byteOrder == kIndexFileByteOrder && header->version == kIndexFileVersion &&
+			header->synctexSize == fileSize && header->synctexModified == (qint64)fileModified.toTime_t() &&
+			header->synctexHash == fileHash(synctexFile) &&
+			validRange(header->sheetsStart, header->numSheets, sizeof(qint64), size) &&
+			validRange(header->lineLocationsStart, header->numLineLocations, sizeof(LineLocation), size) &&
+			validRange(header->checkpointsStart, header->numCheckpoints, sizeof(SyncTeXIndexFileCheckpoint), size) &&
+			validRange(header->inputsStart, 0, 0, size);
+
+	QVector<SyncTeXCheckpoint> mappedCheckpoints;
+	const SyncTeXIndexFileCheckpoint *checkpoint = (const SyncTeXIndexFileCheckpoint*)(data + header->checkpointsStart);
+	for (int i = 0; valid && i < header->numCheckpoints; ++i, ++checkpoint) {
+		valid = validRange(checkpoint->windowStart, checkpoint->windowSize, 1, size);
+		if (valid)
+			mappedCheckpoints << SyncTeXCheckpoint(checkpoint->compressedOffset, checkpoint->bits, checkpoint->offset,
+					QByteArray::fromRawData((const char*)data + checkpoint->windowStart, checkpoint->windowSize));
+	}
+
+	QMap<int, QString> mappedInputs;
+	qint64 pos = header->inputsStart;
+	for (int i = 0; valid && i < header->numInputs; ++i) {
+		qint32 values[2];	// tag and length of the name
+		valid = validRange(pos, 2, sizeof(qint32), size);
+		if (!valid)
+			break;
+		memcpy(values, data + pos, sizeof(values));
+		pos += sizeof(values);
+		valid = validRange(pos, values[1], 1, size);
+		if (valid)
+			mappedInputs.insert(values[0], QString::fromUtf8((const char*)data + pos, values[1]));
+		pos += values[1];
+	}
+
+	if (!valid) {
+		indexFile.unmap((uchar*)data);
+		indexFile.close();
+		return false;
+	}
+	unit = header->unit;
+	xOffset = header->xOffset;
+	yOffset = header->yOffset;
+	sheetOffsetData = (const qint64*)(data + header->sheetsStart);
+	numSheets = header->numSheets;
+	lineLocationData = (const LineLocation*)(data + header->lineLocationsStart);
+	numLineLocations = header->numLineLocations;
+	checkpoints = mappedCheckpoints;
+	inputNames = mappedInputs;
+	return true;
+}
+
+void SyncTeXIndex::writeIndexFile(const QString& indexFileName) const
+{
+	SyncTeXIndexFileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, kIndexFileMagic, sizeof(kIndexFileMagic));
+	header.byteOrder = kIndexFileByteOrder;
+	header.version = kIndexFileVersion;
+	header.synctexSize = fileSize;
+	header.synctexModified = fileModified.toTime_t();
+	header.synctexHash = fileHash(synctexFile);
+	header.numSheets = numSheets;
+	header.numLineLocations = numLineLocations;
+	header.numCheckpoints = checkpoints.size();
+	header.numInputs = inputNames.size();
+	header.unit = unit;
+	header.xOffset = xOffset;
+	header.yOffset = yOffset;
+
+	QByteArray data(sizeof(header), '\0');
+	alignData(data);
+	header.sheetsStart = data.size();
+	appendData(data, sheetOffsetData, numSheets * sizeof(qint64));
+	alignData(data);
+	header.lineLocationsStart = data.size();
+	appendData(data, lineLocationData, numLineLocations * sizeof(LineLocation));
+	alignData(data);
+
+	// the windows follow the table of checkpoints
+	header.checkpointsStart = data.size();
+	qint64 windowStart = data.size() + checkpoints.size() * sizeof(SyncTeXIndexFileCheckpoint);
+	foreach (const SyncTeXCheckpoint& checkpoint, checkpoints) {
+		SyncTeXIndexFileCheckpoint entry;
+		entry.compressedOffset = checkpoint.compressedOffset;
+		entry.offset = checkpoint.offset;
+		entry.windowStart = windowStart;
+		entry.bits = checkpoint.bits;
+		entry.windowSize = checkpoint.window.size();
+		appendData(data, &entry, sizeof(entry));
+		windowStart += checkpoint.window.size();
+	}
+	foreach (const SyncTeXCheckpoint& checkpoint, checkpoints)
+		data.append(checkpoint.window);
+	alignData(data);
+
+	header.inputsStart = data.size();
+	QMap<int, QString>::const_iterator i;
+	for (i = inputNames.constBegin(); i != inputNames.constEnd(); ++i) {
+		QByteArray name = i.value().toUtf8();
+		qint32 values[2] = { i.key(), name.size() };
+		appendData(data, values, sizeof(values));
+		data.append(name);
+	}
+	memcpy(data.data(), &header, sizeof(header));
+
+	// write to a temporary file first, so no incomplete index is ever used;
+	// failing to write it (e.g., in a read-only directory) is not an error
+	QFileInfo fi(indexFileName);
+	QTemporaryFile file(fi.absoluteDir().absoluteFilePath(fi.fileName() + ".XXXXXX"));
+	if (!file.open())
+		return;
+	if (file.write(data) != data.size())
+		return;
+	file.setAutoRemove(false);
+	file.close();
+	QFile::remove(indexFileName);
+	if (!QFile::rename(file.fileName(), indexFileName))
+		QFile::remove(file.fileName());
+}
+
+#pragma mark === page loading ===
+
+QList<int> SyncTeXIndex::pagesForEditQuery(int pageIdx) const
+{
+	QList<int> result;
+	if (pageIdx >= 0 && pageIdx < numSheets)
+		result << pageIdx;
+	return result;
+}
+
+// usually, the page chosen by displayQuery() is all that is needed
+QList<int> SyncTeXIndex::pagesForDisplayQuery(int tag, int line) const
+{
+	QList<int> result;
+	const LineLocation *location = displayLocation(tag, line);
+	if (location != NULL)
+		result << location->pageIdx;
+	return result;
+}
+
+bool SyncTeXIndex::isLoaded(const QList<int>& pageIndices) const
+{
+	QMutexLocker locker(&cacheMutex);
+	foreach (int pageIdx, pageIndices) {
+		if (!loadedPages.contains(pageIdx))
+			return false;
+	}
+	return true;
+}
+
+void SyncTeXIndex::loadPages(const QList<int>& pageIndices) const
+{
+	SyncTeXStream stream(synctexFile);
+	foreach (int pageIdx, pageIndices) {
+		if (!isLoaded(QList<int>() << pageIdx))
+			loadPage(stream, pageIdx);
+	}
+}
+
+SyncTeXIndex::Page SyncTeXIndex::pageData(int pageIdx) const
+{
+	{
+		QMutexLocker locker(&cacheMutex);
+		Page *cachedPage = loadedPages.object(pageIdx);
+		if (cachedPage != NULL)
+			return *cachedPage;
+	}
+	SyncTeXStream stream(synctexFile);
+	return loadPage(stream, pageIdx);
+}
+
+SyncTeXIndex::Page SyncTeXIndex::loadPage(SyncTeXStream& stream, int pageIdx) const
+{
+	Page result;
+	// the offsets are useless if the file was rewritten in the meantime; the
+	// page stays empty then (the PDF will be reloaded anyway)
+	if (pageIdx >= 0 && pageIdx < numSheets && sheetOffsetData[pageIdx] >= 0 &&
+			fileUnchanged() && stream.seek(sheetOffsetData[pageIdx], checkpoints)) {
+		parseSheet(stream, result);
+		finishPage(result);
+	}
+	QMutexLocker locker(&cacheMutex);
+	loadedPages.insert(pageIdx, new Page(result), qMin(result.records.size() + 1, loadedPages.maxCost()));
+	return result;
+}
+
+void SyncTeXIndex::parseSheet(SyncTeXStream& stream, Page& page)
+{
+	const char *line = stream.nextLine();
+	if (line == NULL || *line != '{')
+		return;
+	int nestedSheets = 0;
+	qint32 currentBox = -1;
+	while ((line = stream.nextLine()) != NULL) {
+		if (*line == '{')
+			++nestedSheets;
+		else if (*line == '}') {
+			if (nestedSheets == 0)
+				break;
+			--nestedSheets;
+		}
+		// the contents of nested sheets (form XObjects) are not used
+		else if (nestedSheets == 0)
+			addRecord(page, currentBox, line);
+	}
+}
+
+void SyncTeXIndex::addRecord(Page& page, qint32& currentBox, const char *line)
+{
+	if (*line == ']' || *line == ')') {
+		if (currentBox < 0)
+			return;
+		Record& box = page.records[currentBox];
+		box.end = page.records.size();
+		if (box.end == currentBox + 1) {
+			// only empty boxes are targets of forward searches themselves
+			LineEntry entry = { box.tag, box.line, currentBox };
+			page.lines << entry;
+		}
+		else if (box.type == kHBox) {
+			page.hboxes << qMakePair(box.v - qAbs(box.height), currentBox);
+			page.maxHBoxExtent = qMax(page.maxHBoxExtent, qAbs(box.height) + qAbs(box.depth));
+		}
+		currentBox = box.parent;
+		return;
+	}
+
+	int type = recordType(*line);
+	// anchors and records we don't use
+	if (type < 0)
+		return;
+	Record record;
+	record.type = type;
+	int numValues = (record.isBox() ? 7 : (type == kKern ? 5 : 4));
+	qint32 values[7] = { 0, 0, 0, 0, 0, 0, 0 };
+	if (!decodeIntegers(line + 1, values, numValues))
+		return;
+	record.tag = values[0];
+	record.line = values[1];
+	record.h = values[2];
+	record.v = values[3];
+	record.width = values[4];
+	record.height = values[5];
+	record.depth = values[6];
+	record.visibleLeft = record.h;
+	record.visibleRight = record.h + qAbs(record.width);
+	record.parent = currentBox;
+	qint32 index = page.records.size();
+	record.end = index + 1;
+
+	// the visible extent of an hbox covers everything it contains
+	switch (record.type) {
+		case kHBox:
+		case kVoidHBox:
+			extendHBox(page, currentBox, record.h);
+			extendHBox(page, currentBox, record.h + qAbs(record.width));
+			break;
+		case kKern:
+			extendHBox(page, currentBox, record.h);
+			extendHBox(page, currentBox, record.h - record.width);
+			break;
+		case kGlue:
+		case kMath:
+		case kBoundary:
+			extendHBox(page, currentBox, record.h);
+			break;
+		default:
+			break;
+	}
+
+	page.records << record;
+	if (record.type == kVBox || record.type == kHBox)
+		currentBox = index;
+	else {
+		LineEntry entry = { record.tag, record.line, index };
+		page.lines << entry;
+	}
+}
+
+void SyncTeXIndex::extendHBox(Page& page, qint32 index, qint32 h)
+{
+	if (index < 0)
+		return;
+	Record& box = page.records[index];
+	if (box.type != kHBox)
+		return;
+	box.visibleLeft = qMin(box.visibleLeft, h);
+	box.visibleRight = qMax(box.visibleRight, h);
+}
+
+void SyncTeXIndex::finishPage(Page& page)
+{
+	qSort(page.hboxes);
+	qSort(page.lines);
+	page.hboxes.squeeze();
+	page.lines.squeeze();
+	page.records.squeeze();
+}
+
+bool SyncTeXIndex::LineEntry::operator<(const LineEntry& other) const
+{
+	if (tag != other.tag)
+		return tag < other.tag;
+	if (line != other.line)
+		return line < other.line;
+	return record < other.record;
+}
+
+#pragma mark === queries ===
+
+// the type of the records starting with c, -1 for those that are not used
+int SyncTeXIndex::recordType(char c)
+{
+	switch (c) {
+		case '[': return kVBox;
+		case '(': return kHBox;
+		case 'v': return kVoidVBox;
+		case 'h': return kVoidHBox;
+		case 'k': return kKern;
+		case 'g': return kGlue;
+		case '$': return kMath;
+		case 'x': return kBoundary;
+		default: return -1;
+	}
+}
+
+// forward searches prefer boundaries over other nodes, and those over boxes
+int SyncTeXIndex::displayPriority(int type)
+{
+	switch (type) {
+		case kBoundary:
+			return 0;
+		case kKern:
+		case kGlue:
+		case kMath:
+			return 1;
+		default:
+			return 2;
+	}
+}
+
+QRectF SyncTeXIndex::boxRect(const Record& record) const
+{
+	qint32 left = record.h, width = record.width;
+	if (record.type == kHBox) {
+		left = record.visibleLeft;
+		width = record.visibleRight - record.visibleLeft;
+	}
+	return QRectF(left * unit + xOffset, (record.v - record.height) * unit + yOffset,
+				  width * unit, (record.height + record.depth) * unit).normalized();
+}
+
+// Inverse searches use the rules of the SyncTeX parser that TeXworks used
+// before (version 1.17): the smallest non-empty hbox containing the point (or
+// the first record of the page), narrowed to the deepest box inside it that
+// contains the point; then, of its children, the closest ones on either side
+// (horizontally in hboxes, vertically in vboxes), narrowed again to the
+// closest of their descendants. Distances are in file units and positive
+// (to the right, or below) unless noted; records that are not boxes have no
+// extent apart from kerns.
+class SyncTeXIndex::PointQuery
+{
+public:
+	PointQuery(const Page& p, qint32 x, qint32 y) : page(p), h(x), v(y) { }
+
+	qint32 result() const;
+
+private:
+	qint32 firstChild(qint32 index) const;
+	qint32 nextSibling(qint32 index) const;
+	qint32 hDistance(const Record& record) const;	// signed, negative to the left
+	qint32 vDistance(const Record& record) const;	// signed, negative above
+	bool contains(const Record& record) const;
+	qint32 distance(const Record& record) const;
+	qint32 smallestHBox() const;
+	qint32 deepestContainer(qint32 index) const;
+	qint32 closestDescendant(qint32 index, qint32& bestDistance) const;
+	qint32 closestChild(qint32 index) const;
+	qint32 narrow(qint32 index) const;
+
+	const Page& page;
+	const qint32 h, v;
+};
+
+qint32 SyncTeXIndex::PointQuery::firstChild(qint32 index) const
+{
+	const Record& record = page.records[index];
+	if ((record.type == kVBox || record.type == kHBox) && record.end > index + 1)
+		return index + 1;
+	return -1;
+}
+
+qint32 SyncTeXIndex::PointQuery::nextSibling(qint32 index) const
+{
+	const Record& record = page.records[index];
+	qint32 end = (record.parent >= 0 ? page.records[record.parent].end : page.records.size());
+	return (record.end < end ? record.end : -1);
+}
+
+qint32 SyncTeXIndex::PointQuery::hDistance(const Record& record) const
+{
+	qint32 min, max;
+	switch (record.type) {
+		case kHBox:
+			min = record.visibleLeft;
+			max = record.visibleRight;
+			break;
+		case kVBox:
+		case kVoidVBox:
+		case kVoidHBox:
+			min = record.h;
+			max = record.h + qAbs(record.width);
+			break;
+		case kKern:
+		{
+			// the position of a kern is recorded after it; the point is
+			// considered to be next to its closer edge, with a penalty so
+			// that overlapping records are preferred
+			min = qMin(record.h - record.width, record.h);
+			max = qMax(record.h - record.width, record.h);
+			qint32 med = (min + max) / 2;
+			if (h < min)
+				return min - h + 1;
+			if (h > max)
+				return max - h - 1;
+			return (h > med ? max - h + 1 : min - h - 1);
+		}
+		case kGlue:
+		case kMath:
+			return record.h - h;
+		default:
+			return INT_MAX;
+	}
+	if (h < min)
+		return min - h;
+	if (h > max)
+		return max - h;
+	return 0;
+}
+
+qint32 SyncTeXIndex::PointQuery::vDistance(const Record& record) const
+{
+	if (!record.isBox())
+		return (record.type == kBoundary ? INT_MAX : record.v - v);
+	qint32 min = record.v - qAbs(record.height);
+	qint32 max = record.v + qAbs(record.depth);
+	if (v < min)
+		return min - v;
+	if (v > max)
+		return max - v;
+	return 0;
+}
+
+bool SyncTeXIndex::PointQuery::contains(const Record& record) const
+{
+	return hDistance(record) == 0 && vDistance(record) == 0;
+}
+
+// the distance to the (recorded) box, or to the edges of a kern, as the sum
+// of the horizontal and vertical ones
+qint32 SyncTeXIndex::PointQuery::distance(const Record& record) const
+{
+	qint32 minH = record.h, maxH = record.h;
+	qint32 minV = record.v, maxV = record.v;
+	if (record.isBox()) {
+		maxH += qAbs(record.width);
+		minV -= qAbs(record.height);
+		maxV += qAbs(record.depth);
+	}
+	else if (record.type == kKern) {
+		minH = qMin(record.h - record.width, record.h);
+		maxH = qMax(record.h - record.width, record.h);
+	}
+	else if (record.type == kBoundary)
+		return INT_MAX;
+	qint32 dh = (h < minH ? minH - h : (h > maxH ? h - maxH : 0));
+	qint32 dv = (v < minV ? minV - v : (v > maxV ? v - maxV : 0));
+	return dh + dv;
+}
+
+// of the hboxes containing the point, the narrowest (then the lowest), and of
+// equal ones the last to be closed (i.e., the outermost, or the last one)
+qint32 SyncTeXIndex::PointQuery::smallestHBox() const
+{
+	// the top of a box can be at most maxHBoxExtent above the point
+	qint32 best = -1;
+	QVector< QPair<qint32, qint32> >::const_iterator i =
+		qLowerBound(page.hboxes.constBegin(), page.hboxes.constEnd(), qMakePair(v - page.maxHBoxExtent, (qint32)-1));
+	for (; i != page.hboxes.constEnd() && i->first <= v; ++i) {
+		const Record& box = page.records[i->second];
+		if (!contains(box))
+			continue;
+		if (best >= 0) {
+			const Record& other = page.records[best];
+			qint32 width = qAbs(box.width), otherWidth = qAbs(other.width);
+			qint32 height = qAbs(box.height) + qAbs(box.depth);
+			qint32 otherHeight = qAbs(other.height) + qAbs(other.depth);
+			if (width > otherWidth || (width == otherWidth && height > otherHeight))
+				continue;
+			if (width == otherWidth && height == otherHeight &&
+					(box.end < other.end || (box.end == other.end && i->second > best)))
+				continue;
+		}
+		best = i->second;
+	}
+	return best;
+}
+
+// the deepest box at index or inside it that contains the point; for
+// vboxes, that is replaced by the closest of their children that have
+// children themselves
+qint32 SyncTeXIndex::PointQuery::deepestContainer(qint32 index) const
+{
+	const Record& record = page.records[index];
+	if (record.type != kVBox && record.type != kHBox)
+		return -1;
+	for (qint32 child = firstChild(index); child >= 0; child = nextSibling(child)) {
+		qint32 result = deepestContainer(child);
+		if (result >= 0)
+			return result;
+	}
+	if (!contains(record))
+		return -1;
+	qint32 result = index;
+	if (record.type == kVBox) {
+		qint32 bestDistance = INT_MAX;
+		for (qint32 child = firstChild(index); child >= 0; child = nextSibling(child)) {
+			if (firstChild(child) < 0)
+				continue;
+			qint32 d = distance(page.records[child]);
+			if (d < bestDistance) {
+				bestDistance = d;
+				result = child;
+			}
+		}
+	}
+	return result;
+}
+
+// of the descendants of index, the last one closest to the point (if closer
+// than bestDistance)
+qint32 SyncTeXIndex::PointQuery::closestDescendant(qint32 index, qint32& bestDistance) const
+{
+	qint32 best = -1;
+	for (qint32 child = firstChild(index); child >= 0; child = nextSibling(child)) {
+		qint32 d = distance(page.records[child]);
+		if (d <= bestDistance) {
+			bestDistance = d;
+			best = child;
+		}
+		qint32 candidate = closestDescendant(child, bestDistance);
+		if (candidate >= 0)
+			best = candidate;
+	}
+	return best;
+}
+
+// the closest descendant; if that is a box, its closest child (apart from
+// the first one, as in the SyncTeX parser)
+qint32 SyncTeXIndex::PointQuery::closestChild(qint32 index) const
+{
+	qint32 bestDistance = INT_MAX;
+	qint32 best = closestDescendant(index, bestDistance);
+	qint32 child = (best >= 0 ? firstChild(best) : -1);
+	if (child < 0)
+		return best;
+	bestDistance = distance(page.records[child]);
+	while ((child = nextSibling(child)) >= 0) {
+		qint32 d = distance(page.records[child]);
+		if (d <= bestDistance) {
+			bestDistance = d;
+			best = child;
+		}
+	}
+	return best;
+}
+
+qint32 SyncTeXIndex::PointQuery::narrow(qint32 index) const
+{
+	qint32 container = deepestContainer(index);
+	if (container >= 0)
+		index = container;
+	qint32 child = closestChild(index);
+	return (child >= 0 ? child : index);
+}
+
+qint32 SyncTeXIndex::PointQuery::result() const
+{
+	qint32 box = smallestHBox();
+	if (box < 0)
+		box = 0;
+	qint32 container = deepestContainer(box);
+	if (container >= 0)
+		box = container;
+
+	const Record& record = page.records[box];
+	if (record.type != kVBox && record.type != kHBox)
+		return box;
+	qint32 left = -1, right = -1;
+	qint32 leftDistance = INT_MAX, rightDistance = INT_MAX;
+	bool newLeft = false, newRight = false;
+	for (qint32 child = firstChild(box); child >= 0; child = nextSibling(child)) {
+		const Record& node = page.records[child];
+		qint32 offset = (record.type == kHBox ? hDistance(node) : vDistance(node));
+		if (offset == 0) {
+			// the point is inside the child
+			left = child;
+			right = -1;
+			leftDistance = rightDistance = 0;
+			newLeft = true;
+			continue;
+		}
+		// of records at the same distance, the one of the earlier line is used
+		qint32& best = (offset > 0 ? right : left);
+		qint32& bestDistance = (offset > 0 ? rightDistance : leftDistance);
+		bool& isNew = (offset > 0 ? newRight : newLeft);
+		offset = qAbs(offset);
+		if (offset < bestDistance || (offset == bestDistance && best >= 0 &&
+				page.records[best].tag == node.tag && page.records[best].line > node.line)) {
+			best = child;
+			bestDistance = offset;
+			isNew = true;
+		}
+	}
+	if (newLeft && left >= 0)
+		left = narrow(left);
+	if (newRight && right >= 0)
+		right = narrow(right);
+
+	if (left >= 0 && right >= 0)
+		return (leftDistance > rightDistance ? right : left);
+	if (right >= 0)
+		return right;
+	if (left >= 0)
+		return left;
+	return box;
+}
+
+bool SyncTeXIndex::editQuery(int pageIdx, const QPointF& pos, int& tag, int& line) const
+{
+	if (pageIdx < 0 || pageIdx >= numSheets || unit <= 0)
+		return false;
+	const Page page = pageData(pageIdx);
+	if (page.records.isEmpty())
+		return false;
+	// the point is truncated to file units, as by the SyncTeX parser
+	PointQuery query(page, (qint32)((pos.x() - xOffset) / unit), (qint32)((pos.y() - yOffset) / unit));
+	const Record& hit = page.records[query.result()];
+	tag = hit.tag;
+	line = hit.line;
+	return true;
+}
+
+// The location used to show the given line of input tag (or, failing that,
+// the next one that produced any material): the first page showing records
+// of the line's best priority anywhere.
+const SyncTeXIndex::LineLocation *SyncTeXIndex::displayLocation(int tag, int line) const
+{
+	LineLocation key = { tag, line, -1, 0 };
+	const LineLocation *end = lineLocationData + numLineLocations;
+	const LineLocation *first = qLowerBound(lineLocationData, end, key);
+	if (first == end || first->tag != tag)
+		return NULL;
+	const LineLocation *result = first;
+	for (const LineLocation *i = first; i != end && i->tag == tag && i->line == first->line; ++i) {
+		if (i->priority < result->priority)
+			result = i;
+	}
+	return result;
+}
+
+// the boxes containing the records of the line with the given priority;
+// empty boxes are only shown if there is nothing else
+QList<QRectF> SyncTeXIndex::lineRects(const Page& page, int tag, int line, int priority) const
+{
+	QList<QRectF> rects, emptyRects;
+	QSet<qint32> boxes;
+	LineEntry key = { tag, line, -1 };
+	QVector<LineEntry>::const_iterator i = qLowerBound(page.lines.constBegin(), page.lines.constEnd(), key);
+	for (; i != page.lines.constEnd() && i->tag == tag && i->line == line; ++i) {
+		const Record& record = page.records[i->record];
+		if (displayPriority(record.type) != priority)
+			continue;
+		// nodes are represented by the box they are in
+		qint32 boxIndex = (record.isBox() ? i->record : record.parent);
+		if (boxIndex < 0 || boxes.contains(boxIndex))
+			continue;
+		boxes.insert(boxIndex);
+		QRectF rect = boxRect(page.records[boxIndex]);
+		if (rect.isNull())
+			emptyRects << rect;
+		else
+			rects << rect;
+	}
+	return (rects.isEmpty() ? emptyRects : rects);
+}
+
+int SyncTeXIndex::displayQuery(int tag, int line, QList<QRectF>& rects) const
+{
+	const LineLocation *location = displayLocation(tag, line);
+	if (location == NULL) {
+		rects.clear();
+		return -1;
+	}
+	rects = lineRects(pageData(location->pageIdx), tag, location->line, location->priority);
+	return (rects.isEmpty() ? -1 : location->pageIdx);
+}
+
+QMap<int, QList<QRectF> > SyncTeXIndex::displayRangeQuery(int tag, int firstLine, int lastLine) const
+{
+	QMap<int, QList<QRectF> > result;
+	LineLocation key = { tag, firstLine, -1, 0 };
+	const LineLocation *end = lineLocationData + numLineLocations;
+	for (const LineLocation *location = qLowerBound(lineLocationData, end, key);
+			location != end && location->tag == tag && location->line <= lastLine; ++location) {
+		// as in displayQuery(), each line is shown by its most specific records
+		// (though on every page showing it)
+		const QList<QRectF> lineBoxes = lineRects(pageData(location->pageIdx), tag, location->line, location->priority);
+		if (lineBoxes.isEmpty())
+			continue;
+		QList<QRectF>& rects = result[location->pageIdx];
+		foreach (const QRectF& rect, lineBoxes) {
+			if (!rects.contains(rect))
+				rects << rect;
+		}
+	}
+	return result;
+}
+
+bool SyncTeXIndex::LineLocation::pageIdxLessThan(const LineLocation& a, const LineLocation& b)
+{
+	return a.pageIdx < b.pageIdx;
+}
+
+QList< QPair<int, int> > SyncTeXIndex::pageLines(int pageIdx) const
+{
+	QMutexLocker locker(&cacheMutex);
+	if (pageLineLocations.size() != numLineLocations) {
+		// a stable sort keeps the locations of each page sorted by (tag, line)
+		pageLineLocations.resize(numLineLocations);
+		qCopy(lineLocationData, lineLocationData + numLineLocations, pageLineLocations.begin());
+		qStableSort(pageLineLocations.begin(), pageLineLocations.end(), LineLocation::pageIdxLessThan);
+	}
+	QList< QPair<int, int> > result;
+	LineLocation key = { 0, 0, pageIdx, 0 };
+	QVector<LineLocation>::const_iterator location = qLowerBound(pageLineLocations.constBegin(), pageLineLocations.constEnd(), key, LineLocation::pageIdxLessThan);
+	for (; location != pageLineLocations.constEnd() && location->pageIdx == pageIdx; ++location)
+		result << qMakePair((int)location->tag, (int)location->line);
+	return result;
+}
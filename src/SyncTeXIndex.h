@@ -0,0 +1,228 @@
+/*
+	This is part of TeXworks, an environment for working with TeX documents
+	Copyright (C) 2007-2012  Jonathan Kew, Stefan Löffler, Charlie Sharpsteen
+
+	This program is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	For links to further information, or to contact the authors,
+	see <http://www.tug.org/texworks/>.
+*/
+
+
+#ifndef SyncTeXIndex_H
+#define SyncTeXIndex_H
+
+#include <QString>
+#include <QMap>
+#include <QVector>
+#include <QList>
+#include <QPair>
+#include <QPointF>
+#include <QRectF>
+#include <QByteArray>
+#include <QDateTime>
+#include <QMutex>
+#include <QCache>
+#include <QFile>
+#include <QSharedData>
+
+class SyncTeXStream;
+class SyncTeXIndex;
+
+// an index is shared by the PDF window and the queries it runs in worker
+// threads, so the window can drop it without waiting for those
+typedef QExplicitlySharedDataPointer<SyncTeXIndex> SyncTeXIndexPointer;
+
+// A position in a compressed SyncTeX file from which decompression can be
+// resumed: the offsets in the compressed and the decompressed data, the number
+// of bits of the preceding byte that belong to the next block, and the last
+// 32 kB of decompressed data, which the following blocks may refer to.
+class SyncTeXCheckpoint
+{
+public:
+	SyncTeXCheckpoint(qint64 in = 0, int numBits = 0, qint64 out = 0, const QByteArray& w = QByteArray())
+		: compressedOffset(in), bits(numBits), offset(out), window(w)
+		{ }
+
+	qint64	compressedOffset;
+	int		bits;
+	qint64	offset;
+	QByteArray	window;
+};
+
+// maximum number of records of parsed pages kept in memory
+const int kMaxLoadedSyncTeXRecords = 1 << 20;
+
+// Compact representation of the SyncTeX data of a PDF file.
+// load() makes a single streaming pass over the (compressed) .synctex file
+// that only notes where each sheet starts and which input lines it shows,
+// plus checkpoints that allow decompression to resume close to any sheet.
+// The records of a page are parsed when a query needs them, into a flat
+// table in file order (so the contents of a box directly follow it), with
+// horizontal boxes sorted by their vertical position and all forward-search
+// targets sorted by (input, line). Parsed pages are cached up to a limit.
+// Coordinates are stored in the integer units of the file and converted to
+// PDF points (relative to the top left corner of the page) when queried.
+// The result of the initial pass is saved in a binary index file next to the
+// PDF, which is memory-mapped instead of scanning the SyncTeX file again as
+// long as that is unchanged.
+// Queries and loadPages() may be called from different threads.
+class SyncTeXIndex : public QSharedData
+{
+public:
+	// returns a null pointer if there is no (valid) SyncTeX data for the
+	// given PDF file
+	static SyncTeXIndexPointer load(const QString& pdfFileName);
+
+	QString synctexFileName() const { return synctexFile; }
+	// maps input tags to the file names recorded by TeX
+	const QMap<int, QString>& inputs() const { return inputNames; }
+	int numPages() const { return numSheets; }
+
+	// the pages that have to be parsed to answer a query
+	QList<int> pagesForEditQuery(int pageIdx) const;
+	QList<int> pagesForDisplayQuery(int tag, int line) const;
+	bool isLoaded(const QList<int>& pageIndices) const;
+	// parses the given pages unless they are loaded already; this is what
+	// takes time, so it is typically run in a background thread
+	void loadPages(const QList<int>& pageIndices) const;
+
+	// both queries parse the pages they need if they are not loaded yet
+	// finds the source line that produced the material at pos (in points) on
+	// the page with the given index; returns false if there is none
+	bool editQuery(int pageIdx, const QPointF& pos, int& tag, int& line) const;
+	// returns the index of the first page showing the most specific material
+	// (boundaries, then other nodes, then boxes) from the given line of input
+	// tag (or, failing that, from the next line that produced any), and the
+	// boxes containing it on that page; -1 if nothing is found
+	int displayQuery(int tag, int line, QList<QRectF>& rects) const;
+
+	// batch queries, answered in a single pass over the index
+	// maps each page showing material from lines firstLine to lastLine of
+	// input tag to the boxes containing it (parsing the pages if necessary)
+	QMap<int, QList<QRectF> > displayRangeQuery(int tag, int firstLine, int lastLine) const;
+	// the (tag, line) pairs of the input lines that contributed to the page
+	// with the given index, sorted
+	QList< QPair<int, int> > pageLines(int pageIdx) const;
+
+private:
+	SyncTeXIndex(const QString& fileName);
+
+	typedef enum {
+		kVBox, kHBox, kVoidVBox, kVoidHBox, kKern, kGlue, kMath, kBoundary
+	} RecordType;
+
+	class Record
+	{
+	public:
+		qint32	tag;
+		qint32	line;
+		qint32	h, v;
+		qint32	width, height, depth;	// as recorded, possibly negative
+		qint32	visibleLeft, visibleRight;	// for hboxes, the extent of all their contents
+		qint32	parent;	// index of the enclosing box, -1 at the top level
+		qint32	end;	// the index following the record and its descendants
+		quint8	type;
+
+		bool isBox() const { return type <= kVoidHBox; }
+	};
+
+	// an entry of the (tag, line) index of a page
+	class LineEntry
+	{
+	public:
+		qint32	tag;
+		qint32	line;
+		qint32	record;
+
+		bool operator<(const LineEntry& other) const;
+	};
+
+	class Page
+	{
+	public:
+		Page() : maxHBoxExtent(0) { }
+
+		QVector<Record>	records;
+		QVector< QPair<qint32, qint32> >	hboxes;	// non-empty ones, (top, record index), sorted
+		qint32	maxHBoxExtent;	// largest height + depth of the hboxes
+		QVector<LineEntry>	lines;	// sorted
+	};
+
+	// a line of input that contributed to a page
+	class LineLocation
+	{
+	public:
+		qint32	tag;
+		qint32	line;
+		qint32	pageIdx;
+		qint32	priority;	// the best displayPriority() of the line's records on the page
+
+		bool operator<(const LineLocation& other) const;
+		bool operator==(const LineLocation& other) const
+			{ return tag == other.tag && line == other.line && pageIdx == other.pageIdx; }
+		static bool pageIdxLessThan(const LineLocation& a, const LineLocation& b);
+	};
+
+	bool scan(SyncTeXStream& stream);
+	bool mapIndexFile(const QString& indexFileName);
+	void writeIndexFile(const QString& indexFileName) const;
+	void parseInput(const char *line);
+	void addLineLocations(QVector<LineLocation>& locations);
+	bool fileUnchanged() const;
+
+	Page pageData(int pageIdx) const;
+	Page loadPage(SyncTeXStream& stream, int pageIdx) const;
+	static void parseSheet(SyncTeXStream& stream, Page& page);
+	static void addRecord(Page& page, qint32& currentBox, const char *line);
+	static void extendHBox(Page& page, qint32 index, qint32 h);
+	static void finishPage(Page& page);
+
+	static int recordType(char c);
+	static int displayPriority(int type);
+	QRectF boxRect(const Record& record) const;
+	const LineLocation *displayLocation(int tag, int line) const;
+	QList<QRectF> lineRects(const Page& page, int tag, int line, int priority) const;
+
+	// the rules by which editQuery() chooses a record
+	class PointQuery;
+
+	QString	synctexFile;
+	qint64	fileSize;
+	QDateTime	fileModified;
+	QMap<int, QString>	inputNames;
+	QVector<qint64>	sheetOffsets;	// in the decompressed data, -1 if missing
+	QVector<LineLocation>	lineLocations;	// sorted
+
+	// the data used by queries; either that of the vectors above, or of the
+	// mapped index file
+	const qint64	*sheetOffsetData;
+	int		numSheets;
+	const LineLocation	*lineLocationData;
+	int		numLineLocations;
+	QFile	indexFile;
+	QVector<SyncTeXCheckpoint>	checkpoints;
+
+	mutable QMutex	cacheMutex;
+	mutable QCache<int, Page>	loadedPages;	// cost is the number of records
+	// the line locations sorted by page, made by the first pageLines() query
+	mutable QVector<LineLocation>	pageLineLocations;
+
+	// conversion of file units to points
+	double	unit;
+	double	xOffset;
+	double	yOffset;
+};
+
+#endif
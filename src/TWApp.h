@@ -226,6 +226,8 @@ signals:
 	void dictionaryListChanged() const;
 	
 	void syncPdf(const QString& sourceFile, int lineNo, bool activatePreview);
+	// emitted when the range of lines visible in a source window changes
+	void sourceLinesVisible(const QString& sourceFile, int firstLine, int lastLine);
 
 	void hideFloatersExcept(QWidget* theWindow);
 
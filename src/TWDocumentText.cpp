@@ -0,0 +1,73 @@
+/*
+	This is part of TeXworks, an environment for working with TeX documents
+	Copyright (C) 2007-2012  Jonathan Kew, Stefan Löffler, Charlie Sharpsteen
+
+	This program is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	For links to further information, or to contact the authors,
+	see <http://www.tug.org/texworks/>.
+*/
+
+#include "TWDocumentText.h"
+
+#include <QTextDocument>
+
+TWDocumentText::TWDocumentText(const QTextDocument *document)
+	: doc(document), blockStart(0)
+{
+}
+
+int TWDocumentText::length() const
+{
+	// characterCount() includes the final paragraph separator, which is not
+	// part of toPlainText()
+	return doc->characterCount() - 1;
+}
+
+void TWDocumentText::reset()
+{
+	block = QTextBlock();
+	text.clear();
+}
+
+// makes the block containing pos the cached one; returns false if pos is
+// outside the document
+bool TWDocumentText::loadBlock(int pos) const
+{
+	if (block.isValid() && pos >= blockStart && pos < blockStart + text.length())
+		return true;
+	if (pos < 0 || pos >= length())
+		return false;
+	// neighbouring blocks are found without searching the whole document
+	if (block.isValid() && pos == blockStart + text.length())
+		block = block.next();
+	else if (block.isValid() && block.previous().isValid() && pos < blockStart && pos >= block.previous().position())
+		block = block.previous();
+	else
+		block = doc->findBlock(pos);
+	if (!block.isValid())
+		return false;
+	blockStart = block.position();
+	text = block.text();
+	if (block.next().isValid())
+		text += QChar('\n');
+	return true;
+}
+
+QChar TWDocumentText::at(int pos) const
+{
+	if (!loadBlock(pos))
+		return QChar();
+	return text[pos - blockStart];
+}
@@ -0,0 +1,58 @@
+/*
+	This is part of TeXworks, an environment for working with TeX documents
+	Copyright (C) 2007-2012  Jonathan Kew, Stefan Löffler, Charlie Sharpsteen
+
+	This program is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	For links to further information, or to contact the authors,
+	see <http://www.tug.org/texworks/>.
+*/
+
+#ifndef TWDocumentText_H
+#define TWDocumentText_H
+
+#include <QString>
+#include <QTextBlock>
+
+class QTextDocument;
+
+// Read access to the text of a QTextDocument for code that only looks at a
+// few characters around a position, like the handling of a keystroke. Unlike
+// QTextDocument::toPlainText(), only the blocks actually read are copied, so
+// the cost does not depend on the size of the document. Block separators read
+// as '\n', like in toPlainText(). The block read last is cached, so reading
+// consecutive characters is cheap; reset() must be called after modifying the
+// document.
+class TWDocumentText
+{
+public:
+	TWDocumentText(const QTextDocument *document);
+
+	int length() const;
+	// returns a null QChar for positions outside the document
+	QChar at(int pos) const;
+	QChar operator[](int pos) const { return at(pos); }
+
+	void reset();
+
+private:
+	bool loadBlock(int pos) const;
+
+	const QTextDocument	*doc;
+	mutable QTextBlock	block;
+	mutable int		blockStart;
+	mutable QString	text;	// of block, including the separator if there is one
+};
+
+#endif
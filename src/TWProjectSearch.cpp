@@ -0,0 +1,392 @@
+/*
+	This is part of TeXworks, an environment for working with TeX documents
+	Copyright (C) 2007-2012  Jonathan Kew, Stefan Löffler, Charlie Sharpsteen
+
+	This program is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	For links to further information, or to contact the authors,
+	see <http://www.tug.org/texworks/>.
+*/
+
+#include "TWProjectSearch.h"
+#include "TeXDocument.h"
+#include "TWApp.h"
+#include "TWUtils.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDirIterator>
+#include <QDataStream>
+#include <QDateTime>
+#include <QTextCodec>
+#include <QTextStream>
+#include <QMutexLocker>
+#include <QSet>
+#include <QStatusBar>
+#include <QtConcurrentRun>
+#include <QtConcurrentMap>
+
+#pragma mark === TWSearchIndex ===
+
+static const quint32 kSearchIndexMagic = 0x54574958;	// "TWIX"
+static const quint32 kSearchIndexVersion = 1;
+
+#define PEEK_LENGTH 1024
+
+TWSearchIndex *TWSearchIndex::theInstance = NULL;
+
+TWSearchIndex *TWSearchIndex::instance()
+{
+	if (theInstance == NULL) {
+		QString dirName = TWUtils::getLibraryPath("search-index");
+		QDir::root().mkpath(dirName);
+		// the codecs are looked up here, as the workers must not do that
+		theInstance = new TWSearchIndex(QDir(dirName).absoluteFilePath("index.dat"),
+										TWApp::instance()->getDefaultCodec(), TeXDocument::encodingCodecs());
+		theInstance->load();
+	}
+	return theInstance;
+}
+
+TWSearchIndex::TWSearchIndex(const QString& indexFileName, QTextCodec *codec, const QHash<QString, QTextCodec*>& encodingCodecs)
+	: indexFile(indexFileName)
+	, defaultCodec(codec)
+	, codecs(encodingCodecs)
+	, changed(false)
+{
+}
+
+void TWSearchIndex::load()
+{
+	QFile file(indexFile);
+	if (!file.open(QIODevice::ReadOnly))
+		return;
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_4_0);
+	quint32 magic, version;
+	qint32 count;
+	stream >> magic >> version >> count;
+	if (magic != kSearchIndexMagic || version != kSearchIndexVersion)
+		return;
+	while (count-- > 0 && stream.status() == QDataStream::Ok) {
+		QString fileName;
+		Entry entry;
+		quint32 modified;
+		stream >> fileName >> entry.size >> modified >> entry.trigrams >> entry.includes;
+		entry.modified = modified;
+		if (stream.status() == QDataStream::Ok && entry.trigrams.size() == kSearchIndexBits)
+			entries.insert(fileName, entry);
+	}
+}
+
+void TWSearchIndex::save()
+{
+	QMutexLocker locker(&mutex);
+	if (!changed)
+		return;
+	QFile file(indexFile);
+	if (!file.open(QIODevice::WriteOnly))
+		return;
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_4_0);
+	stream << kSearchIndexMagic << kSearchIndexVersion << (qint32)entries.count();
+	for (QHash<QString, Entry>::const_iterator it = entries.constBegin(); it != entries.constEnd(); ++it)
+		stream << it.key() << it->size << (quint32)it->modified << it->trigrams << it->includes;
+	changed = false;
+}
+
+QString TWSearchIndex::readFile(const QString& fileName) const
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly))
+		return QString();
+	QByteArray data = file.readAll();
+
+	QString reqName = TeXDocument::requestedEncoding(QString(data.left(PEEK_LENGTH)));
+	QTextCodec *codec = (reqName.isNull() ? NULL : codecs.value(reqName.toLower()));
+	if (codec == NULL)
+		codec = defaultCodec;
+	QString text = codec->toUnicode(data);
+	text.replace("\r\n", "\n");
+	text.replace('\r', '\n');
+	return text;
+}
+
+TWSearchIndex::Entry TWSearchIndex::scan(const QString& text)
+{
+	Entry entry;
+	entry.trigrams = QBitArray(kSearchIndexBits);
+	QString folded = text.toCaseFolded();
+	for (int i = 0; i + 2 < folded.length(); ++i)
+		entry.trigrams.setBit(TWTextSearch::trigramHash(folded[i], folded[i + 1], folded[i + 2]) & (kSearchIndexBits - 1));
+
+	QRegExp includeRE("\\\\(?:input|include)\\s*\\{([^}]+)\\}|\\\\input\\s+([^\\s{}%\\\\]+)");
+	foreach (QString line, text.split('\n')) {
+		// strip comments
+		for (int i = 0; i < line.length(); ++i) {
+			if (line[i] == '\\')
+				++i;
+			else if (line[i] == '%') {
+				line.truncate(i);
+				break;
+			}
+		}
+		int pos = 0;
+		while ((pos = includeRE.indexIn(line, pos)) >= 0) {
+			QString name = includeRE.cap(1).isEmpty() ? includeRE.cap(2) : includeRE.cap(1);
+			entry.includes << name.trimmed();
+			pos += includeRE.matchedLength();
+		}
+	}
+	return entry;
+}
+
+bool TWSearchIndex::upToDateEntry(const QString& fileName, Entry& entry, QString *text)
+{
+	QFileInfo info(fileName);
+	if (!info.exists()) {
+		QMutexLocker locker(&mutex);
+		if (entries.remove(fileName) > 0)
+			changed = true;
+		return false;
+	}
+	qint64 size = info.size();
+	uint modified = info.lastModified().toTime_t();
+	{
+		QMutexLocker locker(&mutex);
+		QHash<QString, Entry>::const_iterator it = entries.constFind(fileName);
+		if (it != entries.constEnd() && it->size == size && it->modified == modified) {
+			entry = it.value();
+			return true;
+		}
+	}
+
+	// read and scan the file without holding the lock
+	QString str = readFile(fileName);
+	if (str.isNull())
+		return false;
+	entry = scan(str);
+	entry.size = size;
+	entry.modified = modified;
+	{
+		QMutexLocker locker(&mutex);
+		entries.insert(fileName, entry);
+		changed = true;
+	}
+	if (text != NULL)
+		*text = str;
+	return true;
+}
+
+bool TWSearchIndex::mayContain(const QString& fileName, const QVector<uint>& trigrams, QString& text)
+{
+	Entry entry;
+	if (!upToDateEntry(fileName, entry, &text))
+		return false;
+	foreach (uint trigram, trigrams) {
+		if (!entry.trigrams.testBit(trigram & (kSearchIndexBits - 1)))
+			return false;
+	}
+	return true;
+}
+
+QStringList TWSearchIndex::includes(const QString& fileName)
+{
+	Entry entry;
+	if (!upToDateEntry(fileName, entry, NULL))
+		return QStringList();
+	return entry.includes;
+}
+
+#pragma mark === TWProjectFileSearch ===
+
+TWProjectFileSearch::result_type TWProjectFileSearch::operator()(const QString& fileName) const
+{
+	result_type results;
+	QString text;
+	QHash<QString, QString>::const_iterator it = texts.constFind(fileName);
+	if (it != texts.constEnd())
+		text = it.value();
+	else {
+		TWSearchIndex *index = TWSearchIndex::instance();
+		if (!index->mayContain(fileName, trigrams, text))
+			return results;
+		if (text.isNull())
+			text = index->readFile(fileName);
+	}
+
+	int lineNo = 1, lineStart = 0;
+	foreach (const TWTextMatch& match, search.findAll(text)) {
+		int lineEnd;
+		while ((lineEnd = text.indexOf('\n', lineStart)) >= 0 && lineEnd < match.start) {
+			lineStart = lineEnd + 1;
+			++lineNo;
+		}
+		if (lineEnd < 0)
+			lineEnd = text.length();
+		results << SearchResult(fileName, lineNo, match.start - lineStart,
+								match.start + match.length - lineStart, text.mid(lineStart, lineEnd - lineStart));
+	}
+	return results;
+}
+
+#pragma mark === TWProjectSearch ===
+
+void TWProjectSearch::start(TeXDocument *doc, const TWTextSearch& search)
+{
+	// set up the index in the GUI thread
+	TWSearchIndex::instance();
+	SearchResults *resultsWindow = SearchResults::presentResults(search.text(), QList<SearchResult>(), doc, false);
+	new TWProjectSearch(resultsWindow, doc, search);
+}
+
+TWProjectSearch::TWProjectSearch(SearchResults *resultsWindow, TeXDocument *doc, const TWTextSearch& textSearch)
+	: QObject(resultsWindow)
+	, results(resultsWindow)
+	, document(doc)
+	, search(textSearch)
+	, walkState(new TWProjectWalkState)
+	, finder(NULL)
+	, searcher(NULL)
+{
+	// open documents are searched as they are in the editor, starting with doc;
+	// untitled ones are left out, as their results could not be opened
+	QList<TeXDocument*> docs = TeXDocument::documentList();
+	docs.removeAll(doc);
+	docs.prepend(doc);
+	foreach (TeXDocument *openDoc, docs) {
+		if (openDoc->untitled())
+			continue;
+		QString fileName = openDoc->fileName();
+		if (!QFileInfo(fileName).canonicalFilePath().isEmpty())
+			fileName = QFileInfo(fileName).canonicalFilePath();
+		if (openTexts.contains(fileName))
+			continue;
+		openFiles << fileName;
+		openTexts.insert(fileName, openDoc->textDoc()->toPlainText());
+	}
+
+	QSETTINGS_OBJECT(settings);
+	QString extraDirectory = settings.value(SEARCH_DIRECTORY_SETTING).toString();
+	QString rootFile = doc->untitled() ? QString() : doc->getRootFilePath();
+
+	results->setSearching(true);
+	finder = new QFutureWatcher<QStringList>(this);
+	connect(finder, SIGNAL(finished()), this, SLOT(filesFound()));
+	finder->setFuture(QtConcurrent::run(&TWProjectSearch::projectFiles, rootFile, extraDirectory, walkState));
+}
+
+TWProjectSearch::~TWProjectSearch()
+{
+	// nothing is waited for; the workers stop after the file they are busy
+	// with, and their results are dropped along with the watchers
+	walkState->cancelled = 1;
+	if (searcher != NULL)
+		searcher->cancel();
+}
+
+// the file a \input or \include refers to; these are relative to the
+// directory of the root file, and .tex is added if needed
+static QString resolveInclude(const QDir& rootDir, const QString& name)
+{
+	QFileInfo info(rootDir, name);
+	if (info.suffix().isEmpty() || !info.exists())
+		info = QFileInfo(rootDir, name + ".tex");
+	if (!info.exists())
+		return QString();
+	return info.canonicalFilePath();
+}
+
+QStringList TWProjectSearch::projectFiles(const QString& rootFile, const QString& extraDirectory, WalkStatePointer state)
+{
+	QStringList files;
+	QSet<QString> seen;
+	if (rootFile.isEmpty())
+		return files;
+
+	QFileInfo rootInfo(rootFile);
+	QDir rootDir = rootInfo.absoluteDir();
+	TWSearchIndex *index = TWSearchIndex::instance();
+	QStringList queue;
+	if (rootInfo.exists())
+		queue << rootInfo.canonicalFilePath();
+	while (!queue.isEmpty()) {
+		if (state->cancelled)
+			return QStringList();
+		QString fileName = queue.takeFirst();
+		if (seen.contains(fileName))
+			continue;
+		seen.insert(fileName);
+		files << fileName;
+		foreach (const QString& name, index->includes(fileName)) {
+			QString path = resolveInclude(rootDir, name);
+			if (!path.isEmpty() && !seen.contains(path))
+				queue << path;
+		}
+	}
+
+	if (!extraDirectory.isEmpty()) {
+		QDir dir(rootDir.absoluteFilePath(extraDirectory));
+		QStringList nameFilters;
+		nameFilters << "*.tex" << "*.ltx" << "*.dtx" << "*.sty" << "*.cls" << "*.bib";
+		QDirIterator it(dir.absolutePath(), nameFilters, QDir::Files, QDirIterator::Subdirectories);
+		while (it.hasNext()) {
+			if (state->cancelled)
+				return QStringList();
+			QString fileName = QFileInfo(it.next()).canonicalFilePath();
+			if (!seen.contains(fileName)) {
+				seen.insert(fileName);
+				files << fileName;
+			}
+		}
+	}
+	return files;
+}
+
+void TWProjectSearch::filesFound()
+{
+	QStringList files = openFiles;
+	foreach (const QString& fileName, finder->result()) {
+		if (!openTexts.contains(fileName))
+			files << fileName;
+	}
+
+	searcher = new QFutureWatcher< QList<SearchResult> >(this);
+	connect(searcher, SIGNAL(resultReadyAt(int)), this, SLOT(resultsReady(int)));
+	connect(searcher, SIGNAL(finished()), this, SLOT(searchFinished()));
+	searcher->setFuture(QtConcurrent::mapped(files, TWProjectFileSearch(search, openTexts)));
+}
+
+void TWProjectSearch::resultsReady(int index)
+{
+	QList<SearchResult> newResults = searcher->resultAt(index);
+	if (!newResults.isEmpty())
+		results->addResults(newResults);
+}
+
+void TWProjectSearch::searchFinished()
+{
+	results->setSearching(false);
+	TWSearchIndex::instance()->save();
+	if (document) {
+		if (results->resultCount() == 0) {
+			qApp->beep();
+			document->statusBar()->showMessage(tr("Not found"), kStatusMessageDuration);
+			results->deleteLater();
+		}
+		else
+			document->statusBar()->showMessage(tr("Found %n occurrence(s)", "", results->resultCount()), kStatusMessageDuration);
+	}
+}
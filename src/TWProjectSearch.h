@@ -0,0 +1,162 @@
+/*
+	This is part of TeXworks, an environment for working with TeX documents
+	Copyright (C) 2007-2012  Jonathan Kew, Stefan Löffler, Charlie Sharpsteen
+
+	This program is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	For links to further information, or to contact the authors,
+	see <http://www.tug.org/texworks/>.
+*/
+
+#ifndef TWProjectSearch_H
+#define TWProjectSearch_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QBitArray>
+#include <QMutex>
+#include <QPointer>
+#include <QFutureWatcher>
+#include <QSharedData>
+#include <QAtomicInt>
+
+#include "TWTextSearch.h"
+#include "FindDialog.h"
+
+class QTextCodec;
+class TeXDocument;
+
+// number of bits in the trigram signature of a file in the search index
+const int kSearchIndexBits = 1 << 16;
+
+// setting for a directory whose TeX files are searched in addition to the
+// files of the project (relative paths refer to the root file's directory)
+#define SEARCH_DIRECTORY_SETTING "searchProjectDirectory"
+
+// On-disk index of the files searched by "all files" searches. For each
+// file, it keeps a signature of the (case folded) trigrams it contains, with
+// one bit per trigram hash, and the files it refers to with \input and
+// \include. An entry is only updated when the size or modification time of
+// its file changed. All methods may be called from any thread.
+class TWSearchIndex
+{
+public:
+	static TWSearchIndex *instance();
+
+	// returns false if fileName certainly doesn't contain all of trigrams;
+	// if the file had to be read to find out, its text is put into text
+	bool mayContain(const QString& fileName, const QVector<uint>& trigrams, QString& text);
+	// the files fileName refers to (as written in the file)
+	QStringList includes(const QString& fileName);
+
+	// reads a file the way TeXDocument does (honoring %!TEX encoding), but
+	// with plain \n line endings; returns a null string on failure
+	QString readFile(const QString& fileName) const;
+
+	// write the index to disk if it changed
+	void save();
+
+private:
+	TWSearchIndex(const QString& indexFileName, QTextCodec *codec, const QHash<QString, QTextCodec*>& encodingCodecs);
+
+	struct Entry {
+		qint64		size;
+		uint		modified;
+		QBitArray	trigrams;
+		QStringList	includes;
+	};
+
+	// returns false if the file can't be read; sets text if it was read
+	bool upToDateEntry(const QString& fileName, Entry& entry, QString *text);
+	static Entry scan(const QString& text);
+	void load();
+
+	QMutex	mutex;
+	QHash<QString, Entry>	entries;
+	QString	indexFile;
+	QTextCodec	*defaultCodec;
+	QHash<QString, QTextCodec*>	codecs;	// see TeXDocument::encodingCodecs()
+	bool	changed;
+
+	static TWSearchIndex	*theInstance;
+};
+
+// Searches one file; used with QtConcurrent::mapped. Open documents are
+// searched in their current state (texts maps their file names to their
+// contents), the others using the search index.
+class TWProjectFileSearch
+{
+public:
+	typedef QList<SearchResult> result_type;
+
+	TWProjectFileSearch(const TWTextSearch& textSearch, const QHash<QString, QString>& openTexts)
+		: search(textSearch), trigrams(textSearch.requiredTrigrams()), texts(openTexts)
+		{ }
+
+	result_type operator()(const QString& fileName) const;
+
+private:
+	TWTextSearch	search;
+	QVector<uint>	trigrams;
+	QHash<QString, QString>	texts;
+};
+
+// Shared by a search and the walk through the project's files that it runs
+// in a worker thread, as either may end first.
+class TWProjectWalkState : public QSharedData
+{
+public:
+	QAtomicInt	cancelled;
+};
+
+// A search through all files of a project, as found from the root file's
+// \input and \include commands (plus the files in the directory given by
+// the SEARCH_DIRECTORY_SETTING), and all open documents. Files are searched
+// in parallel and the results are added to a SearchResults window as they
+// come in. The search belongs to that window, so closing it stops the search.
+class TWProjectSearch : public QObject
+{
+	Q_OBJECT
+
+public:
+	static void start(TeXDocument *doc, const TWTextSearch& search);
+	virtual ~TWProjectSearch();
+
+	typedef QExplicitlySharedDataPointer<TWProjectWalkState> WalkStatePointer;
+
+	// the project's files, starting with rootFile; runs in a worker thread,
+	// and stops (returning nothing) when state is cancelled
+	static QStringList projectFiles(const QString& rootFile, const QString& extraDirectory, WalkStatePointer state);
+
+private slots:
+	void filesFound();
+	void resultsReady(int index);
+	void searchFinished();
+
+private:
+	TWProjectSearch(SearchResults *resultsWindow, TeXDocument *doc, const TWTextSearch& textSearch);
+
+	SearchResults	*results;
+	QPointer<TeXDocument>	document;
+	TWTextSearch	search;
+	QStringList		openFiles;	// in the order they are searched
+	QHash<QString, QString>	openTexts;
+	WalkStatePointer	walkState;
+	QFutureWatcher<QStringList>	*finder;
+	QFutureWatcher< QList<SearchResult> >	*searcher;
+};
+
+#endif
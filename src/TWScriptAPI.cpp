@@ -352,6 +352,29 @@ int TWScriptAPI::fileExists(const QString& filename) const
 	return (QFileInfo(path).exists() ? SystemAccess_OK : SystemAccess_Failed);
 }
 
+//////////////// Batch SyncTeX queries ////////////////
+Q_INVOKABLE
+QList<QVariant> TWScriptAPI::syncLinesToRects(QObject* window, const QString& sourceFile, int firstLine, int lastLine)
+{
+	QList<QVariant> retVal;
+	if (window)
+		QMetaObject::invokeMethod(window, "syncLinesToRects", Qt::DirectConnection,
+								  Q_RETURN_ARG(QList<QVariant>, retVal), Q_ARG(QString, sourceFile),
+								  Q_ARG(int, firstLine), Q_ARG(int, lastLine));
+	return retVal;
+}
+
+Q_INVOKABLE
+QList<QVariant> TWScriptAPI::syncPageToLines(QObject* window, int pageIndex)
+{
+	QList<QVariant> retVal;
+	if (window)
+		QMetaObject::invokeMethod(window, "syncPageToLines", Qt::DirectConnection,
+								  Q_RETURN_ARG(QList<QVariant>, retVal), Q_ARG(int, pageIndex));
+	return retVal;
+}
+//////////////// Batch SyncTeX queries ////////////////
+
 //////////////// Wrapper around selected TWUtils functions ////////////////
 Q_INVOKABLE
 QMap<QString, QVariant> TWScriptAPI::getDictionaryList(const bool forceReload /* = false */)
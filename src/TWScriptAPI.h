@@ -166,6 +166,25 @@ public:
 	Q_INVOKABLE
 	bool makeConnection(QObject* sender, const QString& signal, QObject* receiver, const QString& slot);
 	
+	//////////////// Batch SyncTeX queries ////////////////
+	// window can be a PDF window or a source window (whose preview is used);
+	// the queries are forwarded to its methods of the same name.
+	// Returns a list of maps, one per page showing material from the lines
+	// firstLine to lastLine (1-based) of sourceFile, with the fields:
+	// - "page" => the 0-based page index
+	// - "rects" => a list of maps with the fields "x", "y", "width" and "height"
+	//              (in points, relative to the top left corner of the page)
+	Q_INVOKABLE
+	QList<QVariant> syncLinesToRects(QObject* window, const QString& sourceFile, int firstLine, int lastLine);
+
+	// Returns a list of maps, one per source file that contributed to the page
+	// with the given (0-based) index, with the fields:
+	// - "file" => the full path of the source file
+	// - "lines" => the (1-based) line numbers, sorted
+	Q_INVOKABLE
+	QList<QVariant> syncPageToLines(QObject* window, int pageIndex);
+	//////////////// Batch SyncTeX queries ////////////////
+
 	//////////////// Wrapper around selected TWUtils functions ////////////////
 	// Returns a map of the type "language code => array(filenames)"
 	// "filenames" are paths to *.dic files associated with the respective
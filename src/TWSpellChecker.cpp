@@ -0,0 +1,230 @@
+/*
+	This is part of TeXworks, an environment for working with TeX documents
+	Copyright (C) 2007-2012  Jonathan Kew, Stefan Löffler, Charlie Sharpsteen
+
+	This program is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	For links to further information, or to contact the authors,
+	see <http://www.tug.org/texworks/>.
+*/
+
+#include "TWSpellChecker.h"
+#include "TWApp.h"
+
+#include <QMutexLocker>
+#include <QTextCodec>
+
+TWSpellChecker *TWSpellChecker::theInstance = NULL;
+
+TWSpellChecker *TWSpellChecker::instance()
+{
+	if (theInstance == NULL) {
+		theInstance = new TWSpellChecker(qApp);
+		QSETTINGS_OBJECT(settings);
+		theInstance->setCacheSize(settings.value("spellCheckCacheSize", kDefault_SpellCheckCacheSize).toInt());
+	}
+	return theInstance;
+}
+
+TWSpellChecker::TWSpellChecker(QObject *parent)
+	: QThread(parent)
+	, cacheSize(kDefault_SpellCheckCacheSize)
+	, lastRequestId(0)
+	, generation(0)
+	, currentRequester(NULL)
+	, quit(false)
+{
+}
+
+TWSpellChecker::~TWSpellChecker()
+{
+	mutex.lock();
+	quit = true;
+	for (int i = 0; i < kNumChannels; ++i)
+		pending[i].clear();
+	requestAvailable.wakeAll();
+	mutex.unlock();
+	wait();
+	qDeleteAll(caches);
+	if (theInstance == this)
+		theInstance = NULL;
+}
+
+// must be called with the mutex locked
+QCache<QString, bool> *TWSpellChecker::cacheFor(Hunhandle *h)
+{
+	QCache<QString, bool> *cache = caches.value(h);
+	if (cache == NULL) {
+		cache = new QCache<QString, bool>(cacheSize);
+		caches.insert(h, cache);
+	}
+	return cache;
+}
+
+TWSpellChecker::WordStatus TWSpellChecker::cachedStatus(Hunhandle *h, const QString& word)
+{
+	QMutexLocker locker(&mutex);
+	const bool *correct = cacheFor(h)->object(word);
+	if (correct == NULL)
+		return kUnknown;
+	return *correct ? kCorrect : kMisspelled;
+}
+
+bool TWSpellChecker::isWordCorrect(Hunhandle *h, QTextCodec *codec, const QString& word)
+{
+	WordStatus status = cachedStatus(h, word);
+	if (status != kUnknown)
+		return status == kCorrect;
+
+	QMutexLocker hunspellLocker(&hunspellMutex);
+	bool correct = (Hunspell_spell(h, codec->fromUnicode(word).data()) != 0);
+	QMutexLocker locker(&mutex);
+	cacheFor(h)->insert(word, new bool(correct));
+	return correct;
+}
+
+QStringList TWSpellChecker::suggestions(Hunhandle *h, QTextCodec *codec, const QString& word)
+{
+	QStringList result;
+	QMutexLocker hunspellLocker(&hunspellMutex);
+	char **suggestionList;
+	int count = Hunspell_suggest(h, &suggestionList, codec->fromUnicode(word).data());
+	for (int i = 0; i < count; ++i) {
+		result << codec->toUnicode(suggestionList[i]);
+		free(suggestionList[i]);
+	}
+	if (count > 0)
+		free(suggestionList);
+	return result;
+}
+
+void TWSpellChecker::ignoreWord(Hunhandle *h, QTextCodec *codec, const QString& word)
+{
+	{
+		QMutexLocker hunspellLocker(&hunspellMutex);
+		(void)Hunspell_add(h, codec->fromUnicode(word).data());
+		// the previous result is outdated now
+		QMutexLocker locker(&mutex);
+		cacheFor(h)->insert(word, new bool(true));
+	}
+	emit wordIgnored(h, word);
+}
+
+int TWSpellChecker::requestWords(QObject *requester, Channel channel, Hunhandle *h, QTextCodec *codec, const QStringList& words)
+{
+	QMutexLocker locker(&mutex);
+	Request request;
+	request.requester = requester;
+	request.id = ++lastRequestId;
+	request.h = h;
+	request.codec = codec;
+	request.words = words;
+	pending[channel] << request;
+	if (!isRunning())
+		start(QThread::LowPriority);
+	requestAvailable.wakeOne();
+	return request.id;
+}
+
+void TWSpellChecker::cancelRequests(QObject *requester)
+{
+	QMutexLocker locker(&mutex);
+	for (int i = 0; i < kNumChannels; ++i) {
+		QList<Request>::iterator it = pending[i].begin();
+		while (it != pending[i].end()) {
+			if (it->requester == requester)
+				it = pending[i].erase(it);
+			else
+				++it;
+		}
+	}
+	if (currentRequester == requester)
+		currentRequester = NULL;
+}
+
+void TWSpellChecker::clear()
+{
+	// wait for a check that may be in progress
+	QMutexLocker hunspellLocker(&hunspellMutex);
+	QMutexLocker locker(&mutex);
+	++generation;
+	for (int i = 0; i < kNumChannels; ++i)
+		pending[i].clear();
+	currentRequester = NULL;
+	qDeleteAll(caches);
+	caches.clear();
+}
+
+void TWSpellChecker::setCacheSize(int words)
+{
+	QMutexLocker locker(&mutex);
+	cacheSize = qMax(1, words);
+	foreach (QCache<QString, bool> *cache, caches)
+		cache->setMaxCost(cacheSize);
+}
+
+// must be called with the mutex locked
+bool TWSpellChecker::takeRequest(Request& request)
+{
+	for (int i = 0; i < kNumChannels; ++i) {
+		if (!pending[i].isEmpty()) {
+			request = pending[i].takeFirst();
+			return true;
+		}
+	}
+	return false;
+}
+
+void TWSpellChecker::run()
+{
+	Request request;
+	while (true) {
+		mutex.lock();
+		while (!quit && !takeRequest(request))
+			requestAvailable.wait(&mutex);
+		if (quit) {
+			mutex.unlock();
+			break;
+		}
+		int requestGeneration = generation;
+		currentRequester = request.requester;
+		mutex.unlock();
+
+		bool finished = true;
+		foreach (const QString& word, request.words) {
+			if (cachedStatus(request.h, word) != kUnknown)
+				continue;
+			QMutexLocker hunspellLocker(&hunspellMutex);
+			// the dictionary may have been destroyed in the meantime
+			if (generation != requestGeneration) {
+				finished = false;
+				break;
+			}
+			bool correct = (Hunspell_spell(request.h, request.codec->fromUnicode(word).data()) != 0);
+			QMutexLocker locker(&mutex);
+			cacheFor(request.h)->insert(word, new bool(correct));
+			if (quit || currentRequester == NULL) {
+				finished = false;
+				break;
+			}
+		}
+
+		mutex.lock();
+		finished = finished && currentRequester != NULL;
+		currentRequester = NULL;
+		mutex.unlock();
+		if (finished)
+			emit wordsChecked(request.requester, request.id);
+	}
+}
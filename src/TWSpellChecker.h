@@ -0,0 +1,131 @@
+/*
+	This is part of TeXworks, an environment for working with TeX documents
+	Copyright (C) 2007-2012  Jonathan Kew, Stefan Löffler, Charlie Sharpsteen
+
+	This program is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	For links to further information, or to contact the authors,
+	see <http://www.tug.org/texworks/>.
+*/
+
+#ifndef TWSpellChecker_H
+#define TWSpellChecker_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QCache>
+#include <QHash>
+#include <QList>
+#include <QStringList>
+
+#include <hunspell.h>
+
+class QTextCodec;
+
+// default number of words per dictionary whose spell check result is kept;
+// can be changed using the "spellCheckCacheSize" setting
+const int kDefault_SpellCheckCacheSize = 50000;
+
+// Process-wide spell checking service. Hunspell handles are shared by all
+// documents using the same language and must not be used from several
+// threads at once, so all calls into Hunspell go through this class and are
+// serialized. Results are kept in an LRU cache per dictionary.
+// Words can be checked synchronously (e.g., for the context menu), or queued
+// for the background thread; requests are grouped in channels like those of
+// the PDFRenderer, lower channel numbers being served first. Once all words
+// of a request are in the cache, wordsChecked() is emitted.
+class TWSpellChecker : public QThread
+{
+	Q_OBJECT
+
+public:
+	typedef enum {
+		kUnknown,		// not in the cache (yet)
+		kCorrect,
+		kMisspelled
+	} WordStatus;
+
+	typedef enum {
+		kVisibleChannel = 0,	// words currently on screen
+		kBackgroundChannel,		// the rest of the document
+		kNumChannels
+	} Channel;
+
+	static TWSpellChecker *instance();
+	virtual ~TWSpellChecker();
+
+	// looks the word up in the cache only, so it never waits for Hunspell
+	WordStatus cachedStatus(Hunhandle *h, const QString& word);
+
+	// synchronous checks; these block until Hunspell is available
+	bool isWordCorrect(Hunhandle *h, QTextCodec *codec, const QString& word);
+	QStringList suggestions(Hunhandle *h, QTextCodec *codec, const QString& word);
+
+	// accept the word for the rest of the session (for all documents using h)
+	void ignoreWord(Hunhandle *h, QTextCodec *codec, const QString& word);
+
+	// queue words for checking in the background; returns the id that is
+	// passed to wordsChecked() once they are all in the cache
+	int requestWords(QObject *requester, Channel channel, Hunhandle *h, QTextCodec *codec, const QStringList& words);
+	void cancelRequests(QObject *requester);
+
+	// forget all results and pending requests; must be called before any
+	// Hunspell handle is destroyed
+	void clear();
+
+	void setCacheSize(int words);
+
+signals:
+	// emitted from the spell checking thread; connections to GUI objects are queued
+	void wordsChecked(QObject *requester, int requestId);
+	// emitted from the GUI thread by ignoreWord()
+	void wordIgnored(Hunhandle *h, const QString& word);
+
+protected:
+	virtual void run();
+
+private:
+	TWSpellChecker(QObject *parent = NULL);
+
+	struct Request {
+		QObject		*requester;
+		int			id;
+		Hunhandle	*h;
+		QTextCodec	*codec;
+		QStringList	words;
+	};
+
+	// must be called with the mutex locked
+	QCache<QString, bool> *cacheFor(Hunhandle *h);
+	bool takeRequest(Request& request);
+
+	// mutex protects the caches and the request queues; hunspellMutex
+	// serializes the Hunspell calls. When both are needed, hunspellMutex
+	// must be locked first.
+	QMutex			mutex;
+	QMutex			hunspellMutex;
+	QWaitCondition	requestAvailable;
+	QList<Request>	pending[kNumChannels];
+	QHash<Hunhandle*, QCache<QString, bool>*>	caches;
+	int		cacheSize;
+	int		lastRequestId;
+	int		generation;	// incremented by clear(); protected by both mutexes
+	QObject	*currentRequester;	// reset to NULL if the running request is cancelled
+	bool	quit;
+
+	static TWSpellChecker	*theInstance;
+};
+
+#endif
@@ -0,0 +1,113 @@
+/*
+	This is part of TeXworks, an environment for working with TeX documents
+	Copyright (C) 2007-2012  Jonathan Kew, Stefan Löffler, Charlie Sharpsteen
+
+	This program is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	For links to further information, or to contact the authors,
+	see <http://www.tug.org/texworks/>.
+*/
+
+#include "TWTagIndex.h"
+
+// the end of [position, position + length), without overflowing
+static int rangeEnd(int position, int length)
+{
+	return (length > INT_MAX - position) ? INT_MAX : position + length;
+}
+
+TWTagIndex::TWTagIndex(QObject *parent)
+	: QObject(parent)
+	, numBookmarks(0)
+	, nextId(0)
+	, deferChanges(false)
+	, pendingChanges(false)
+{
+}
+
+QList<TWTag> TWTagIndex::tags(int position, int length) const
+{
+	QList<TWTag> result;
+	TagMap::const_iterator last = tagMap.lowerBound(rangeEnd(position, length));
+	for (TagMap::const_iterator i = tagMap.lowerBound(position); i != last; ++i)
+		result << i.value();
+	return result;
+}
+
+bool TWTagIndex::setTags(int position, int length, const QList<TWTag>& blockTags)
+{
+	QList<TWTag> oldTags;
+	TagMap::iterator last = tagMap.lowerBound(rangeEnd(position, length));
+	for (TagMap::iterator i = tagMap.lowerBound(position); i != last; ) {
+		oldTags << i.value();
+		if (i.value().isBookmark())
+			--numBookmarks;
+		i = tagMap.erase(i);
+	}
+
+	// the same kinds of tags as before (the usual case while typing) keep
+	// their ids, and are only reported if their texts changed
+	bool sameKinds = (oldTags.count() == blockTags.count());
+	for (int i = 0; sameKinds && i < blockTags.count(); ++i)
+		sameKinds = (oldTags[i].level == blockTags[i].level);
+	bool textChanged = false;
+	for (int i = 0; i < blockTags.count(); ++i) {
+		TWTag tag = blockTags[i];
+		if (sameKinds) {
+			tag.id = oldTags[i].id;
+			textChanged = textChanged || tag.text != oldTags[i].text;
+		}
+		else
+			tag.id = nextId++;
+		if (tag.isBookmark())
+			++numBookmarks;
+		tagMap.insertMulti(Position(tag.cursor), tag);
+	}
+
+	if (sameKinds && !textChanged)
+		return false;
+	changed(position, length);
+	return true;
+}
+
+void TWTagIndex::clear()
+{
+	if (tagMap.isEmpty())
+		return;
+	tagMap.clear();
+	numBookmarks = 0;
+	changed(0, INT_MAX);
+}
+
+void TWTagIndex::changed(int position, int length)
+{
+	emit tagsReplaced(position, length);
+	if (deferChanges)
+		pendingChanges = true;
+	else
+		emit tagsChanged();
+}
+
+void TWTagIndex::beginChanges()
+{
+	deferChanges = true;
+	pendingChanges = false;
+}
+
+void TWTagIndex::endChanges()
+{
+	deferChanges = false;
+	if (pendingChanges)
+		emit tagsChanged();
+}
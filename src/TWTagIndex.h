@@ -0,0 +1,113 @@
+/*
+	This is part of TeXworks, an environment for working with TeX documents
+	Copyright (C) 2007-2012  Jonathan Kew, Stefan Löffler, Charlie Sharpsteen
+
+	This program is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	For links to further information, or to contact the authors,
+	see <http://www.tug.org/texworks/>.
+*/
+
+#ifndef TWTagIndex_H
+#define TWTagIndex_H
+
+#include <QObject>
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QTextCursor>
+
+#include <limits.h>
+
+// A bookmark (level < 1) or outline entry of a TeX document. The cursor
+// selects the text that produced the tag and follows edits of the document;
+// id identifies the tag for as long as it exists.
+class TWTag
+{
+public:
+	TWTag(const QTextCursor& curs = QTextCursor(), int lvl = 0, const QString& txt = QString())
+		: cursor(curs), level(lvl), text(txt), id(-1)
+		{ }
+
+	int position() const { return cursor.selectionStart(); }
+	bool isBookmark() const { return level < 1; }
+
+	QTextCursor	cursor;
+	int			level;
+	QString		text;
+	int			id;
+};
+
+// The tags of a document, ordered by position. Tags are found by the
+// highlighter and replaced one block at a time. They are kept in a map
+// keyed by the current position of their cursors: as the cursors move along
+// with the text, the order of the keys never changes, so the map stays
+// sorted while the document is edited.
+// Each replacement that changes anything is reported right away by
+// tagsReplaced(), with the range involved; tagsChanged() is only emitted
+// once for a series of changes between beginChanges() and endChanges().
+class TWTagIndex : public QObject
+{
+	Q_OBJECT
+
+public:
+	TWTagIndex(QObject *parent = NULL);
+
+	int count() const { return tagMap.count(); }
+	int bookmarkCount() const { return numBookmarks; }
+	// the tags within [position, position + length), in order
+	QList<TWTag> tags(int position = 0, int length = INT_MAX) const;
+
+	// replace the tags within [position, position + length) by blockTags
+	// (which must be in order); returns true if anything changed
+	bool setTags(int position, int length, const QList<TWTag>& blockTags);
+	void clear();
+
+	// collect changes and emit tagsChanged() only once at the end
+	void beginChanges();
+	void endChanges();
+
+signals:
+	// the tags within [position, position + length) have been replaced
+	void tagsReplaced(int position, int length);
+	void tagsChanged();
+
+private:
+	// a fixed position, or the current one of a cursor
+	class Position
+	{
+	public:
+		Position(int pos) : fixedPosition(pos) { }
+		Position(const QTextCursor& curs) : cursor(curs), fixedPosition(-1) { }
+
+		int value() const { return cursor.isNull() ? fixedPosition : cursor.selectionStart(); }
+		bool operator<(const Position& other) const { return value() < other.value(); }
+
+	private:
+		QTextCursor	cursor;
+		int	fixedPosition;
+	};
+
+	typedef QMap<Position, TWTag> TagMap;
+
+	void changed(int position, int length);
+
+	TagMap	tagMap;
+	int		numBookmarks;
+	int		nextId;
+	bool	deferChanges;
+	bool	pendingChanges;
+};
+
+#endif
@@ -0,0 +1,350 @@
+/*
+	This is part of TeXworks, an environment for working with TeX documents
+	Copyright (C) 2007-2012  Jonathan Kew, Stefan Löffler, Charlie Sharpsteen
+
+	This program is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	For links to further information, or to contact the authors,
+	see <http://www.tug.org/texworks/>.
+*/
+
+#include "TWTagsModel.h"
+#include "TWTagIndex.h"
+
+#include <QBrush>
+
+#include <limits.h>
+
+// ids of the nodes that don't represent tags
+enum {
+	kRootNode = -1,
+	kBookmarksNode = -2,
+	kOutlineNode = -3,
+	kNoTagsNode = -4
+};
+
+class TWTagsModel::Node
+{
+public:
+	Node(int nodeId, const QString& nodeText = QString(), Node *parentNode = NULL)
+		: id(nodeId), level(0), text(nodeText), parent(parentNode)
+		{
+			if (parent != NULL)
+				parent->children << this;
+		}
+	Node(const TWTag& tag, Node *parentNode)
+		: id(tag.id), level(tag.level), text(tag.text), cursor(tag.cursor), parent(parentNode)
+		{
+			parent->children << this;
+		}
+	~Node() { qDeleteAll(children); }
+
+	int position() const { return cursor.selectionStart(); }
+	int row() const;
+	// the index of the last child starting before pos, or -1
+	int childBefore(int pos) const;
+
+	int			id;
+	int			level;
+	QString		text;
+	QTextCursor	cursor;	// null for the nodes that don't represent tags
+	Node		*parent;
+	QList<Node*>	children;
+};
+
+int TWTagsModel::Node::childBefore(int pos) const
+{
+	int low = 0, high = children.count();
+	while (low < high) {
+		int mid = (low + high) / 2;
+		if (children[mid]->position() < pos)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	return low - 1;
+}
+
+int TWTagsModel::Node::row() const
+{
+	if (parent == NULL)
+		return 0;
+	// tags are ordered by position among their siblings
+	if (id >= 0) {
+		const int pos = position();
+		for (int i = parent->childBefore(pos) + 1; i < parent->children.count() && parent->children[i]->position() == pos; ++i) {
+			if (parent->children[i] == this)
+				return i;
+		}
+	}
+	return parent->children.indexOf(const_cast<Node*>(this));
+}
+
+TWTagsModel::TWTagsModel(TWTagIndex *tagIndex, QObject *parent)
+	: QAbstractItemModel(parent)
+	, tags(tagIndex)
+{
+	root = buildTree();
+	connect(tags, SIGNAL(tagsReplaced(int, int)), this, SLOT(replaceTags(int, int)));
+}
+
+TWTagsModel::~TWTagsModel()
+{
+	delete root;
+}
+
+TWTagsModel::Node *TWTagsModel::buildTree() const
+{
+	Node *newRoot = new Node(kRootNode);
+	if (tags->count() == 0) {
+		new Node(kNoTagsNode, tr("No tags"), newRoot);
+		return newRoot;
+	}
+
+	// empty groups are not shown
+	for (int i = 0; i < 2; ++i) {
+		bool bookmarks = (i == 0);
+		if (bookmarks ? tags->bookmarkCount() == 0 : tags->count() == tags->bookmarkCount())
+			continue;
+		Node *group = new Node(bookmarks ? kBookmarksNode : kOutlineNode, bookmarks ? tr("Bookmarks") : tr("Outline"), newRoot);
+		foreach (Node *node, buildNodes(bookmarks, 0, INT_MAX)) {
+			node->parent = group;
+			group->children << node;
+		}
+	}
+	return newRoot;
+}
+
+// the nodes of the bookmarks or of the outline within [start, end); outline
+// entries are nested by level
+QList<TWTagsModel::Node*> TWTagsModel::buildNodes(bool bookmarks, int start, int end) const
+{
+	Node top(kRootNode);
+	Node *item = &top;
+	foreach (const TWTag& tag, tags->tags(start, end - start)) {
+		if (tag.isBookmark() != bookmarks)
+			continue;
+		if (bookmarks)
+			new Node(tag, &top);
+		else {
+			while (item != &top && item->level >= tag.level)
+				item = item->parent;
+			item = new Node(tag, item);
+		}
+	}
+	QList<Node*> result = top.children;
+	top.children.clear();
+	return result;
+}
+
+TWTagsModel::Node *TWTagsModel::group(int id) const
+{
+	foreach (Node *node, root->children) {
+		if (node->id == id)
+			return node;
+	}
+	return NULL;
+}
+
+void TWTagsModel::replaceTags(int position, int length)
+{
+	int end = (length > INT_MAX - position) ? INT_MAX : position + length;
+	Node *bookmarks = group(kBookmarksNode);
+	Node *outline = group(kOutlineNode);
+	// the groups come and go with the first and last tags of their kind; that
+	// is rare enough to compare the whole tree
+	if ((bookmarks != NULL) != (tags->bookmarkCount() > 0) ||
+			(outline != NULL) != (tags->count() > tags->bookmarkCount())) {
+		Node *newRoot = buildTree();
+		merge(root, QModelIndex(), newRoot);
+		delete newRoot;
+		return;
+	}
+	if (bookmarks != NULL)
+		updateRange(bookmarks, position, end);
+	if (outline != NULL)
+		updateRange(outline, position, end);
+}
+
+// rebuilds the rows of group that cover [start, end)
+void TWTagsModel::updateRange(Node *group, int start, int end)
+{
+	const bool bookmarks = (group->id == kBookmarksNode);
+	Node *node = group;
+	QModelIndex nodeIndex = index(group->row(), 0);
+	int nodeEnd = INT_MAX;
+	int first = node->childBefore(start);
+	int last = node->childBefore(end);
+
+	// go down the outline as long as a single entry covers the range, and
+	// all the tags now in the range are nested below it
+	if (!bookmarks) {
+		const QList<TWTag> newTags = tags->tags(start, end - start);
+		while (first >= 0 && first == last) {
+			Node *child = node->children[first];
+			bool nested = true;
+			foreach (const TWTag& tag, newTags) {
+				if (!tag.isBookmark() && tag.level <= child->level) {
+					nested = false;
+					break;
+				}
+			}
+			if (!nested)
+				break;
+			if (first + 1 < node->children.count())
+				nodeEnd = node->children[first + 1]->position();
+			nodeIndex = index(first, 0, nodeIndex);
+			node = child;
+			first = node->childBefore(start);
+			last = node->childBefore(end);
+		}
+	}
+
+	// the rows from the one the range starts in to the last one starting in
+	// it; all of their tags are built anew and compared
+	int spanStart = (first >= 0) ? node->children[first]->position() : start;
+	int spanEnd = (last + 1 < node->children.count()) ? node->children[last + 1]->position() : nodeEnd;
+	if (first < 0)
+		first = 0;
+	mergeRows(node, nodeIndex, first, last, buildNodes(bookmarks, spanStart, spanEnd));
+}
+
+// Make node's children the same as newNode's; nodes with the same id are
+// kept (and merged recursively). newNode's children are used up.
+void TWTagsModel::merge(Node *node, const QModelIndex& nodeIndex, Node *newNode)
+{
+	QList<Node*> newChildren = newNode->children;
+	newNode->children.clear();
+	mergeRows(node, nodeIndex, 0, node->children.count() - 1, newChildren);
+}
+
+// Replace node's children from first to last by newChildren (taking them
+// over or deleting them). Only the differing range in the middle is removed
+// and inserted.
+void TWTagsModel::mergeRows(Node *node, const QModelIndex& nodeIndex, int first, int last, const QList<Node*>& newChildren)
+{
+	int oldCount = last - first + 1, newCount = newChildren.count();
+	int prefix = 0;
+	while (prefix < oldCount && prefix < newCount && node->children[first + prefix]->id == newChildren[prefix]->id)
+		++prefix;
+	int suffix = 0;
+	while (suffix < oldCount - prefix && suffix < newCount - prefix
+		   && node->children[last - suffix]->id == newChildren[newCount - 1 - suffix]->id)
+		++suffix;
+
+	if (oldCount - suffix > prefix) {
+		beginRemoveRows(nodeIndex, first + prefix, last - suffix);
+		for (int i = last - suffix; i >= first + prefix; --i)
+			delete node->children.takeAt(i);
+		endRemoveRows();
+	}
+	if (newCount - suffix > prefix) {
+		beginInsertRows(nodeIndex, first + prefix, first + newCount - suffix - 1);
+		for (int i = prefix; i < newCount - suffix; ++i) {
+			newChildren[i]->parent = node;
+			node->children.insert(first + i, newChildren[i]);
+		}
+		endInsertRows();
+	}
+
+	// now the rows match; update the ones that were kept
+	for (int i = 0; i < newCount; ++i) {
+		if (i >= prefix && i < newCount - suffix)
+			continue;
+		Node *child = node->children[first + i];
+		QModelIndex childIndex = index(first + i, 0, nodeIndex);
+		if (child->text != newChildren[i]->text) {
+			child->text = newChildren[i]->text;
+			emit dataChanged(childIndex, childIndex);
+		}
+		child->level = newChildren[i]->level;
+		child->cursor = newChildren[i]->cursor;
+		merge(child, childIndex, newChildren[i]);
+		delete newChildren[i];
+	}
+}
+
+TWTagsModel::Node *TWTagsModel::nodeFor(const QModelIndex& index) const
+{
+	return index.isValid() ? static_cast<Node*>(index.internalPointer()) : root;
+}
+
+QModelIndex TWTagsModel::index(int row, int column, const QModelIndex& parent) const
+{
+	Node *parentNode = nodeFor(parent);
+	if (column != 0 || row < 0 || row >= parentNode->children.count())
+		return QModelIndex();
+	return createIndex(row, column, parentNode->children[row]);
+}
+
+QModelIndex TWTagsModel::parent(const QModelIndex& child) const
+{
+	if (!child.isValid())
+		return QModelIndex();
+	Node *parentNode = nodeFor(child)->parent;
+	if (parentNode == NULL || parentNode == root)
+		return QModelIndex();
+	return createIndex(parentNode->row(), 0, parentNode);
+}
+
+int TWTagsModel::rowCount(const QModelIndex& parent) const
+{
+	if (parent.column() > 0)
+		return 0;
+	return nodeFor(parent)->children.count();
+}
+
+int TWTagsModel::columnCount(const QModelIndex& parent) const
+{
+	Q_UNUSED(parent);
+	return 1;
+}
+
+QVariant TWTagsModel::data(const QModelIndex& index, int role) const
+{
+	if (!index.isValid())
+		return QVariant();
+	Node *node = nodeFor(index);
+	switch (role) {
+		case Qt::DisplayRole:
+			return node->text;
+		case Qt::ForegroundRole:
+			if (node->id == kBookmarksNode || node->id == kOutlineNode)
+				return QBrush(Qt::blue);
+			break;
+	}
+	return QVariant();
+}
+
+Qt::ItemFlags TWTagsModel::flags(const QModelIndex& index) const
+{
+	if (!index.isValid())
+		return 0;
+	switch (nodeFor(index)->id) {
+		case kNoTagsNode:
+			return 0;
+		case kBookmarksNode:
+		case kOutlineNode:
+			return Qt::ItemIsEnabled;
+		default:
+			return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+	}
+}
+
+QTextCursor TWTagsModel::tagCursor(const QModelIndex& index) const
+{
+	if (!index.isValid())
+		return QTextCursor();
+	return nodeFor(index)->cursor;
+}
@@ -0,0 +1,73 @@
+/*
+	This is part of TeXworks, an environment for working with TeX documents
+	Copyright (C) 2007-2012  Jonathan Kew, Stefan Löffler, Charlie Sharpsteen
+
+	This program is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	For links to further information, or to contact the authors,
+	see <http://www.tug.org/texworks/>.
+*/
+
+#ifndef TWTagsModel_H
+#define TWTagsModel_H
+
+#include <QAbstractItemModel>
+#include <QList>
+#include <QTextCursor>
+
+class TWTagIndex;
+
+// Tree model of the tags of a TWTagIndex: bookmarks in one group, and the
+// outline nested by level in another. Each replacement reported by the index
+// is applied to the deepest node whose subtree covers it: only the rows of
+// that node overlapping the range are rebuilt and compared with the current
+// ones, so row insertions and removals are emitted just for what differs,
+// and views keep their state.
+class TWTagsModel : public QAbstractItemModel
+{
+	Q_OBJECT
+
+public:
+	TWTagsModel(TWTagIndex *tagIndex, QObject *parent = NULL);
+	virtual ~TWTagsModel();
+
+	virtual QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const;
+	virtual QModelIndex parent(const QModelIndex& child) const;
+	virtual int rowCount(const QModelIndex& parent = QModelIndex()) const;
+	virtual int columnCount(const QModelIndex& parent = QModelIndex()) const;
+	virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const;
+	virtual Qt::ItemFlags flags(const QModelIndex& index) const;
+
+	// the cursor of the tag shown at index; null for group headers
+	QTextCursor tagCursor(const QModelIndex& index) const;
+
+private slots:
+	void replaceTags(int position, int length);
+
+private:
+	class Node;
+
+	Node *buildTree() const;
+	QList<Node*> buildNodes(bool bookmarks, int start, int end) const;
+	void updateRange(Node *group, int start, int end);
+	void merge(Node *node, const QModelIndex& nodeIndex, Node *newNode);
+	void mergeRows(Node *node, const QModelIndex& nodeIndex, int first, int last, const QList<Node*>& newChildren);
+	Node *nodeFor(const QModelIndex& index) const;
+	Node *group(int id) const;
+
+	TWTagIndex	*tags;
+	Node		*root;
+};
+
+#endif
@@ -0,0 +1,318 @@
+/*
+	This is part of TeXworks, an environment for working with TeX documents
+	Copyright (C) 2007-2012  Jonathan Kew, Stefan Löffler, Charlie Sharpsteen
+
+	This program is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	For links to further information, or to contact the authors,
+	see <http://www.tug.org/texworks/>.
+*/
+
+#include "TWTextSearch.h"
+
+#include <QTextCursor>
+
+// escapes that may match a line break (or stand for arbitrary characters)
+static bool escapeSpansLines(QChar c)
+{
+	return QString("sWDnx0").contains(c);
+}
+
+// Whether the character class starting at pattern[i] ("[") may match a line
+// break; i is moved to the closing "]". Only classes that provably can't are
+// treated as line-local: negated classes, and ranges including a line break
+// or bounded by an escape, may all match one.
+static bool classSpansLines(const QString& pattern, int& i)
+{
+	++i;
+	if (i < pattern.length() && pattern[i] == '^')
+		return true;
+	bool first = true;
+	for (; i < pattern.length(); ++i, first = false) {
+		QChar c = pattern[i];
+		if (c == ']' && !first)
+			return false;
+		if (c == '\\') {
+			if (++i >= pattern.length() || escapeSpansLines(pattern[i]))
+				return true;
+			if (i + 1 < pattern.length() && pattern[i + 1] == '-')
+				return true;
+			continue;
+		}
+		if (c == '\n' || c == QChar::ParagraphSeparator)
+			return true;
+		if (i + 2 < pattern.length() && pattern[i + 1] == '-' && pattern[i + 2] != ']') {
+			QChar last = pattern[i + 2];
+			if (last == '\\')
+				return true;
+			if ((c <= QChar('\n') && last >= QChar('\n'))
+				|| (c <= QChar(QChar::ParagraphSeparator) && last >= QChar(QChar::ParagraphSeparator)))
+				return true;
+			i += 2;
+		}
+	}
+	// unterminated class (the expression is invalid anyway)
+	return true;
+}
+
+// Whether a regular expression may match a line break, or depends on where
+// the searched text starts and ends (^ and $ only match at the start and end
+// of the whole document); this errs on the safe side.
+static bool patternSpansLines(const QString& pattern)
+{
+	for (int i = 0; i < pattern.length(); ++i) {
+		QChar c = pattern[i];
+		if (c == '\\') {
+			if (++i < pattern.length() && escapeSpansLines(pattern[i]))
+				return true;
+		}
+		else if (c == '[') {
+			if (classSpansLines(pattern, i))
+				return true;
+		}
+		else if (c == '.' || c == '^' || c == '$' || c == '\n' || c == QChar::ParagraphSeparator)
+			return true;
+	}
+	return false;
+}
+
+TWTextSearch::TWTextSearch(const QString& text, bool isRegex, QTextDocument::FindFlags flags)
+	: searchText(text)
+	, regex(isRegex)
+	, findFlags(flags)
+	, multiLine(false)
+{
+	if (regex) {
+		pattern = QRegExp(searchText, ((flags & QTextDocument::FindCaseSensitively) != 0)
+										? Qt::CaseSensitive : Qt::CaseInsensitive);
+		multiLine = patternSpansLines(searchText);
+	}
+}
+
+bool TWTextSearch::isValid() const
+{
+	if (searchText.isEmpty())
+		return false;
+	return !regex || pattern.isValid();
+}
+
+TWTextMatch TWTextSearch::nextMatch(const QString& str, int from, QRegExp& re) const
+{
+	if (regex) {
+		int offset = from;
+		while ((offset = re.indexIn(str, offset, QRegExp::CaretAtZero)) >= 0) {
+			if (re.matchedLength() > 0)
+				return TWTextMatch(offset, re.matchedLength());
+			++offset;
+		}
+		return TWTextMatch();
+	}
+
+	Qt::CaseSensitivity cs = ((findFlags & QTextDocument::FindCaseSensitively) != 0)
+								? Qt::CaseSensitive : Qt::CaseInsensitive;
+	bool wholeWords = ((findFlags & QTextDocument::FindWholeWords) != 0);
+	int len = searchText.length();
+	int offset = from;
+	while ((offset = str.indexOf(searchText, offset, cs)) >= 0) {
+		if (wholeWords && ((offset > 0 && str.at(offset - 1).isLetterOrNumber())
+						   || (offset + len < str.length() && str.at(offset + len).isLetterOrNumber()))) {
+			++offset;
+			continue;
+		}
+		return TWTextMatch(offset, len);
+	}
+	return TWTextMatch();
+}
+
+QList<TWTextMatch> TWTextSearch::findAll(const QString& str, int from) const
+{
+	QList<TWTextMatch> matches;
+	if (!isValid())
+		return matches;
+	QRegExp re(pattern);
+	TWTextMatch match = nextMatch(str, from, re);
+	while (match.start >= 0) {
+		matches << match;
+		match = nextMatch(str, match.start + match.length, re);
+	}
+	return matches;
+}
+
+// collects all matches in a list
+class TWTextMatchCollector : public TWTextMatchReceiver
+{
+public:
+	virtual bool foundMatches(const QTextBlock& block, const QList<TWTextMatch>& matches)
+		{
+			Q_UNUSED(block);
+			all << matches;
+			return true;
+		}
+	QList<TWTextMatch> all;
+};
+
+QList<TWTextMatch> TWTextSearch::findAll(QTextDocument *doc, int from, int to) const
+{
+	TWTextMatchCollector collector;
+	findAll(doc, collector, from, to);
+	return collector.all;
+}
+
+void TWTextSearch::findAll(QTextDocument *doc, TWTextMatchReceiver& receiver, int from, int to) const
+{
+	if (!isValid() || doc == NULL)
+		return;
+	if (to < 0)
+		to = doc->characterCount() - 1;
+	QRegExp re(pattern);
+
+	if (multiLine) {
+		// one pass over the whole text; matches are grouped by block
+		const QString text = doc->toPlainText();
+		QTextBlock block = doc->findBlock(from);
+		QList<TWTextMatch> blockMatches;
+		TWTextMatch match = nextMatch(text, from, re);
+		while (match.start >= 0 && match.start + match.length <= to) {
+			if (!block.contains(match.start)) {
+				if (!blockMatches.isEmpty() && !receiver.foundMatches(block, blockMatches))
+					return;
+				blockMatches.clear();
+				block = doc->findBlock(match.start);
+			}
+			blockMatches << match;
+			match = nextMatch(text, match.start + match.length, re);
+		}
+		if (!blockMatches.isEmpty())
+			receiver.foundMatches(block, blockMatches);
+		return;
+	}
+
+	for (QTextBlock block = doc->findBlock(from); block.isValid() && block.position() <= to; block = block.next()) {
+		int blockStart = block.position();
+		const QString text = block.text();
+		QList<TWTextMatch> blockMatches;
+		bool done = false;
+		TWTextMatch match = nextMatch(text, qMax(0, from - blockStart), re);
+		while (match.start >= 0) {
+			if (blockStart + match.start + match.length > to) {
+				done = true;
+				break;
+			}
+			blockMatches << TWTextMatch(blockStart + match.start, match.length);
+			match = nextMatch(text, match.start + match.length, re);
+		}
+		if (!blockMatches.isEmpty() && !receiver.foundMatches(block, blockMatches))
+			return;
+		if (done)
+			return;
+	}
+}
+
+// regular expressions that span lines are matched against the whole text
+TWTextMatch TWTextSearch::findInText(QTextDocument *doc, int from, int to) const
+{
+	const QString text = doc->toPlainText();
+	QRegExp re(pattern);
+	if ((findFlags & QTextDocument::FindBackward) != 0) {
+		int offset = re.lastIndexIn(text, to, QRegExp::CaretAtZero);
+		while (offset >= from && offset + re.matchedLength() > to)
+			offset = (offset > 0) ? re.lastIndexIn(text, offset - 1, QRegExp::CaretAtZero) : -1;
+		if (offset >= from)
+			return TWTextMatch(offset, re.matchedLength());
+		return TWTextMatch();
+	}
+	TWTextMatch match = nextMatch(text, from, re);
+	if (match.start >= 0 && match.start + match.length <= to)
+		return match;
+	return TWTextMatch();
+}
+
+TWTextMatch TWTextSearch::find(QTextDocument *doc, int from, int to) const
+{
+	if (!isValid() || doc == NULL)
+		return TWTextMatch();
+	bool backward = ((findFlags & QTextDocument::FindBackward) != 0);
+
+	if (!regex) {
+		QTextCursor curs;
+		if (backward) {
+			curs = doc->find(searchText, to, findFlags);
+			if (!curs.isNull() && curs.selectionEnd() > to)
+				curs = doc->find(searchText, curs, findFlags);
+			if (curs.isNull() || curs.selectionStart() < from)
+				return TWTextMatch();
+		}
+		else {
+			curs = doc->find(searchText, from, findFlags);
+			if (curs.isNull() || curs.selectionEnd() > to)
+				return TWTextMatch();
+		}
+		return TWTextMatch(curs.selectionStart(), curs.selectionEnd() - curs.selectionStart());
+	}
+
+	if (multiLine)
+		return findInText(doc, from, to);
+
+	QRegExp re(pattern);
+	if (backward) {
+		for (QTextBlock block = doc->findBlock(to); block.isValid(); block = block.previous()) {
+			int blockStart = block.position();
+			if (blockStart + block.length() <= from)
+				break;
+			const QString text = block.text();
+			int limit = qMin(to - blockStart, text.length());
+			int offset = re.lastIndexIn(text, limit, QRegExp::CaretAtZero);
+			while (offset >= 0 && (re.matchedLength() == 0 || blockStart + offset + re.matchedLength() > to))
+				offset = (offset > 0) ? re.lastIndexIn(text, offset - 1, QRegExp::CaretAtZero) : -1;
+			if (offset >= 0) {
+				if (blockStart + offset < from)
+					break;
+				return TWTextMatch(blockStart + offset, re.matchedLength());
+			}
+		}
+		return TWTextMatch();
+	}
+
+	for (QTextBlock block = doc->findBlock(from); block.isValid() && block.position() <= to; block = block.next()) {
+		int blockStart = block.position();
+		TWTextMatch match = nextMatch(block.text(), qMax(0, from - blockStart), re);
+		if (match.start >= 0) {
+			if (blockStart + match.start + match.length > to)
+				break;
+			return TWTextMatch(blockStart + match.start, match.length);
+		}
+	}
+	return TWTextMatch();
+}
+
+uint TWTextSearch::trigramHash(QChar a, QChar b, QChar c)
+{
+	return ((uint)a.unicode() * 0x9E3779B1u) ^ ((uint)b.unicode() * 0x85EBCA6Bu) ^ ((uint)c.unicode() * 0xC2B2AE35u);
+}
+
+QVector<uint> TWTextSearch::requiredTrigrams() const
+{
+	QVector<uint> result;
+	QString literal = searchText;
+	if (regex) {
+		// only patterns without any special characters are treated as literals
+		QRegExp special("[\\\\.^$|?*+()\\[\\]{}]");
+		if (literal.contains(special))
+			return result;
+	}
+	literal = literal.toCaseFolded();
+	for (int i = 0; i + 2 < literal.length(); ++i)
+		result << trigramHash(literal[i], literal[i + 1], literal[i + 2]);
+	return result;
+}
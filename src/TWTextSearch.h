@@ -0,0 +1,102 @@
+/*
+	This is part of TeXworks, an environment for working with TeX documents
+	Copyright (C) 2007-2012  Jonathan Kew, Stefan Löffler, Charlie Sharpsteen
+
+	This program is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	For links to further information, or to contact the authors,
+	see <http://www.tug.org/texworks/>.
+*/
+
+#ifndef TWTextSearch_H
+#define TWTextSearch_H
+
+#include <QString>
+#include <QRegExp>
+#include <QList>
+#include <QVector>
+#include <QTextDocument>
+#include <QTextBlock>
+
+// A match of a TWTextSearch; start refers to the searched string
+class TWTextMatch
+{
+public:
+	TWTextMatch(int matchStart = -1, int matchLength = 0)
+		: start(matchStart), length(matchLength)
+		{ }
+
+	int	start;
+	int	length;
+};
+
+// Receives the matches of TWTextSearch::findAll() in a QTextDocument as they
+// are found, grouped by the block they start in (in document order)
+class TWTextMatchReceiver
+{
+public:
+	virtual ~TWTextMatchReceiver() { }
+	// match positions are relative to the document; return false to stop
+	virtual bool foundMatches(const QTextBlock& block, const QList<TWTextMatch>& matches) = 0;
+};
+
+// A search as set up in the find and replace dialogs (search text, regex
+// option and find flags). Matching works on a copy of the regular
+// expression, so the same object can be used by several threads at once.
+class TWTextSearch
+{
+public:
+	TWTextSearch(const QString& searchText = QString(), bool isRegex = false,
+				 QTextDocument::FindFlags findFlags = 0);
+
+	bool isValid() const;
+	const QString& text() const { return searchText; }
+	bool isRegex() const { return regex; }
+	QTextDocument::FindFlags flags() const { return findFlags; }
+
+	// all non-empty, non-overlapping matches in str (in order); like
+	// QTextDocument::find(), plain text searches honor FindWholeWords
+	QList<TWTextMatch> findAll(const QString& str, int from = 0) const;
+
+	// Search a document without copying all of its text. Unless the regular
+	// expression may match across lines (or depends on the start and end of
+	// the text), the document is searched block by block. Only matches
+	// within [from, to] are found; to < 0 stands for the end of the document.
+	QList<TWTextMatch> findAll(QTextDocument *doc, int from = 0, int to = -1) const;
+	void findAll(QTextDocument *doc, TWTextMatchReceiver& receiver, int from = 0, int to = -1) const;
+	// the first match within [from, to] (the last one if FindBackward is set);
+	// returns a match with start < 0 if there is none
+	TWTextMatch find(QTextDocument *doc, int from, int to) const;
+
+	// true if the regular expression can't be applied to single blocks
+	bool spansLines() const { return multiLine; }
+
+	// hashes of the (case folded) trigrams every text containing a match
+	// must contain; empty if nothing is known about the matches
+	QVector<uint> requiredTrigrams() const;
+	static uint trigramHash(QChar a, QChar b, QChar c);
+
+private:
+	// the first match in str at or after from; re is a copy of pattern
+	TWTextMatch nextMatch(const QString& str, int from, QRegExp& re) const;
+	TWTextMatch findInText(QTextDocument *doc, int from, int to) const;
+
+	QString	searchText;
+	bool	regex;
+	QTextDocument::FindFlags	findFlags;
+	QRegExp	pattern;
+	bool	multiLine;
+};
+
+#endif
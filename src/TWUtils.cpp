@@ -23,6 +23,7 @@
 #include "TWApp.h"
 #include "TeXDocument.h"
 #include "PDFDocument.h"
+#include "TWSpellChecker.h"
 
 #include <QFileDialog>
 #include <QString>
@@ -463,6 +464,8 @@ void TWUtils::clearDictionaries()
 	if (!dictionaries)
 		return;
 	
+	// cached results and queued requests refer to the handles
+	TWSpellChecker::instance()->clear();
 	for (QHash<const QString,Hunhandle*>::iterator it = dictionaries->begin(); it != dictionaries->end(); ++it) {
 		if (it.value())
 			Hunspell_destroy(it.value());
@@ -0,0 +1,357 @@
+/*
+	This is part of TeXworks, an environment for working with TeX documents
+	Copyright (C) 2007-2012  Jonathan Kew, Stefan Löffler, Charlie Sharpsteen
+
+	This program is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	For links to further information, or to contact the authors,
+	see <http://www.tug.org/texworks/>.
+*/
+
+#include "TeXDelimiterIndex.h"
+#include "TWUtils.h"
+
+#include <QTextDocument>
+#include <QTextBlock>
+
+TeXDelimiterIndex *TeXDelimiterIndex::forDocument(QTextDocument *document)
+{
+	TeXDelimiterIndex *index = document->findChild<TeXDelimiterIndex*>();
+	if (index == NULL)
+		index = new TeXDelimiterIndex(document);
+	return index;
+}
+
+TeXDelimiterIndex::TeXDelimiterIndex(QTextDocument *document)
+	: QObject(document), doc(document), treesValid(false)
+{
+	blocks.reserve(doc->blockCount());
+	for (QTextBlock block = doc->begin(); block.isValid(); block = block.next())
+		blocks << parseBlock(block);
+	connect(doc, SIGNAL(contentsChange(int,int,int)), this, SLOT(contentsChange(int,int,int)));
+}
+
+#pragma mark === maintenance ===
+
+TeXDelimiterIndex::Depth::Depth(const Depth& first, const Depth& second)
+	: net(first.net + second.net)
+	, minPrefix(qMin(first.minPrefix, first.net + second.minPrefix))
+	, maxSuffix(qMax(second.maxSuffix, second.net + first.maxSuffix))
+{
+}
+
+TeXDelimiterIndex::Block TeXDelimiterIndex::parseBlock(const QTextBlock& block)
+{
+	Block result;
+	const QString text = block.text();
+	result.text = text;
+	bool inComment = false;
+	for (int i = 0; i < text.length(); ++i) {
+		QChar c = text[i];
+		Delimiter delim;
+		delim.offset = i;
+		delim.length = 1;
+		// as in TWUtils::balanceDelim, closers take precedence
+		if (TWUtils::openerMatching(c) != 0 || TWUtils::closerMatching(c) != 0) {
+			delim.opening = (TWUtils::openerMatching(c) == 0);
+			delim.ch = c;
+			result.delimiters[kBrackets] << delim;
+		}
+
+		// environments are only recognized outside of comments
+		if (c == '%' && (i == 0 || text[i - 1] != '\\'))
+			inComment = true;
+		if (inComment || c != '\\')
+			continue;
+		int nameStart = i + 1;
+		if (text.midRef(nameStart, 5) == QLatin1String("begin")) {
+			delim.opening = true;
+			nameStart += 5;
+		}
+		else if (text.midRef(nameStart, 3) == QLatin1String("end")) {
+			delim.opening = false;
+			nameStart += 3;
+		}
+		else
+			continue;
+		if (nameStart < text.length() && text[nameStart].isLetter())
+			continue;
+		while (nameStart < text.length() && text[nameStart].isSpace())
+			++nameStart;
+		if (nameStart >= text.length() || text[nameStart] != '{')
+			continue;
+		int nameEnd = text.indexOf('}', nameStart);
+		if (nameEnd < 0)
+			continue;
+		delim.length = nameEnd + 1 - i;
+		delim.environment = text.mid(nameStart + 1, nameEnd - nameStart - 1).trimmed();
+		result.delimiters[kEnvironments] << delim;
+	}
+
+	for (int channel = 0; channel < kNumChannels; ++channel) {
+		Depth& depth = result.depth[channel];
+		foreach (const Delimiter& delim, result.delimiters[channel]) {
+			depth.net += (delim.opening ? 1 : -1);
+			depth.minPrefix = qMin(depth.minPrefix, depth.net);
+		}
+		depth.maxSuffix = depth.net - depth.minPrefix;
+	}
+	return result;
+}
+
+void TeXDelimiterIndex::contentsChange(int position, int charsRemoved, int charsAdded)
+{
+	// the blocks from first to last replace numReplaced old ones
+	QTextBlock first = doc->findBlock(position);
+	QTextBlock last = doc->findBlock(position + charsAdded);
+	if (!first.isValid())
+		first = doc->begin();
+	if (!last.isValid())
+		last = doc->lastBlock();
+	int firstNumber = first.blockNumber();
+	int numNew = last.blockNumber() - firstNumber + 1;
+	int numReplaced = numNew - (doc->blockCount() - blocks.size());
+	if (numReplaced < 0 || firstNumber + numReplaced > blocks.size()) {
+		// should not happen; start afresh
+		firstNumber = 0;
+		numNew = doc->blockCount();
+		numReplaced = blocks.size();
+		first = doc->begin();
+	}
+
+	if (numNew == numReplaced) {
+		QTextBlock block = first;
+		for (int i = 0; i < numNew; ++i, block = block.next()) {
+			// format changes (e.g., by the highlighter) leave the text alone
+			if (charsAdded == charsRemoved && blocks[firstNumber + i].text == block.text())
+				continue;
+			blocks[firstNumber + i] = parseBlock(block);
+			changedBlocks << firstNumber + i;
+		}
+		return;
+	}
+
+	if (numNew > numReplaced)
+		blocks.insert(firstNumber + numReplaced, numNew - numReplaced, Block());
+	else
+		blocks.remove(firstNumber + numNew, numReplaced - numNew);
+	QTextBlock block = first;
+	for (int i = 0; i < numNew; ++i, block = block.next())
+		blocks[firstNumber + i] = parseBlock(block);
+	// block numbers changed, so the trees are rebuilt when needed next
+	treesValid = false;
+	changedBlocks.clear();
+}
+
+void TeXDelimiterIndex::update()
+{
+	if (!treesValid) {
+		for (int channel = 0; channel < kNumChannels; ++channel)
+			trees[channel].build(blocks, (Channel)channel);
+		treesValid = true;
+	}
+	else {
+		foreach (int blockNumber, changedBlocks) {
+			for (int channel = 0; channel < kNumChannels; ++channel)
+				trees[channel].update(blockNumber, blocks[blockNumber].depth[channel]);
+		}
+	}
+	changedBlocks.clear();
+}
+
+#pragma mark === DepthTree ===
+
+void TeXDelimiterIndex::DepthTree::build(const QVector<Block>& blocks, Channel channel)
+{
+	numLeaves = 1;
+	while (numLeaves < blocks.size())
+		numLeaves *= 2;
+	nodes.fill(Depth(), 2 * numLeaves);
+	for (int i = 0; i < blocks.size(); ++i)
+		nodes[numLeaves + i] = blocks[i].depth[channel];
+	for (int i = numLeaves - 1; i > 0; --i)
+		nodes[i] = Depth(nodes[2 * i], nodes[2 * i + 1]);
+}
+
+void TeXDelimiterIndex::DepthTree::update(int blockNumber, const Depth& depth)
+{
+	int i = numLeaves + blockNumber;
+	nodes[i] = depth;
+	for (i /= 2; i > 0; i /= 2)
+		nodes[i] = Depth(nodes[2 * i], nodes[2 * i + 1]);
+}
+
+int TeXDelimiterIndex::DepthTree::findForward(int blockNumber, int& level) const
+{
+	return findForward(1, 0, numLeaves - 1, blockNumber, level);
+}
+
+int TeXDelimiterIndex::DepthTree::findBackward(int blockNumber, int& level) const
+{
+	if (blockNumber < 0)
+		return -1;
+	return findBackward(1, 0, numLeaves - 1, blockNumber, level);
+}
+
+// whole subtrees that do not reach the level sought are skipped, so only
+// O(log n) nodes are visited
+int TeXDelimiterIndex::DepthTree::findForward(int node, int first, int last, int blockNumber, int& level) const
+{
+	if (last < blockNumber)
+		return -1;
+	if (first >= blockNumber && level + nodes[node].minPrefix >= 0) {
+		level += nodes[node].net;
+		return -1;
+	}
+	if (first == last)
+		return first;
+	int middle = (first + last) / 2;
+	int found = findForward(2 * node, first, middle, blockNumber, level);
+	if (found < 0)
+		found = findForward(2 * node + 1, middle + 1, last, blockNumber, level);
+	return found;
+}
+
+int TeXDelimiterIndex::DepthTree::findBackward(int node, int first, int last, int blockNumber, int& level) const
+{
+	if (first > blockNumber)
+		return -1;
+	if (last <= blockNumber && level + nodes[node].maxSuffix <= 0) {
+		level += nodes[node].net;
+		return -1;
+	}
+	if (first == last)
+		return first;
+	int middle = (first + last) / 2;
+	int found = findBackward(2 * node + 1, middle + 1, last, blockNumber, level);
+	if (found < 0)
+		found = findBackward(2 * node, first, middle, blockNumber, level);
+	return found;
+}
+
+#pragma mark === queries ===
+
+// returns the index of the delimiter of the given channel that covers pos
+int TeXDelimiterIndex::delimiterAt(Channel channel, int pos, int& blockNumber) const
+{
+	QTextBlock block = doc->findBlock(pos);
+	if (!block.isValid())
+		return -1;
+	blockNumber = block.blockNumber();
+	int offset = pos - block.position();
+	const QVector<Delimiter>& delimiters = blocks[blockNumber].delimiters[channel];
+	for (int i = 0; i < delimiters.size() && delimiters[i].offset <= offset; ++i) {
+		if (offset < delimiters[i].offset + delimiters[i].length)
+			return i;
+	}
+	return -1;
+}
+
+int TeXDelimiterIndex::findPartner(Channel channel, int blockNumber, int index)
+{
+	update();
+	const Delimiter start = blocks[blockNumber].delimiters[channel][index];
+	int level = 0;
+	int step = (start.opening ? 1 : -1);
+	int found = -1;
+	// the rest of the block, then the block found in the tree
+	for (int pass = 0; pass < 2 && found < 0; ++pass) {
+		const QVector<Delimiter>& delimiters = blocks[blockNumber].delimiters[channel];
+		for (int i = index + step; i >= 0 && i < delimiters.size(); i += step) {
+			level += (delimiters[i].opening == start.opening ? 1 : -1);
+			if (level < 0) {
+				found = i;
+				break;
+			}
+		}
+		if (found >= 0 || pass > 0)
+			break;
+		// the tree counts the delimiters closing start's level as -1 going
+		// forward, and the openers as +1 going backward
+		if (start.opening)
+			blockNumber = trees[channel].findForward(blockNumber + 1, level);
+		else {
+			level = -level;
+			blockNumber = trees[channel].findBackward(blockNumber - 1, level);
+			level = -level;
+		}
+		if (blockNumber < 0)
+			return -1;
+		index = (start.opening ? -1 : blocks[blockNumber].delimiters[channel].size());
+	}
+	if (found < 0)
+		return -1;
+
+	const Delimiter& partner = blocks[blockNumber].delimiters[channel][found];
+	if (channel == kBrackets) {
+		QChar opener = (start.opening ? start.ch : partner.ch);
+		QChar closer = (start.opening ? partner.ch : start.ch);
+		if (TWUtils::closerMatching(opener) != closer)
+			return -1;
+	}
+	else if (partner.environment != start.environment)
+		return -1;
+	return doc->findBlockByNumber(blockNumber).position() + partner.offset;
+}
+
+int TeXDelimiterIndex::findEnclosing(Channel channel, int pos)
+{
+	QTextBlock block = doc->findBlock(pos);
+	if (!block.isValid())
+		return -1;
+	update();
+	int blockNumber = block.blockNumber();
+	int offset = pos - block.position();
+	int level = 0;
+	for (int pass = 0; pass < 2; ++pass) {
+		const QVector<Delimiter>& delimiters = blocks[blockNumber].delimiters[channel];
+		for (int i = delimiters.size() - 1; i >= 0; --i) {
+			if (pass == 0 && delimiters[i].offset >= offset)
+				continue;
+			level += (delimiters[i].opening ? 1 : -1);
+			if (level > 0)
+				return doc->findBlockByNumber(blockNumber).position() + delimiters[i].offset;
+		}
+		if (pass > 0)
+			break;
+		blockNumber = trees[channel].findBackward(blockNumber - 1, level);
+		if (blockNumber < 0)
+			break;
+	}
+	return -1;
+}
+
+int TeXDelimiterIndex::matchingDelimiter(int pos)
+{
+	int blockNumber;
+	int index = delimiterAt(kBrackets, pos, blockNumber);
+	return (index < 0 ? -1 : findPartner(kBrackets, blockNumber, index));
+}
+
+int TeXDelimiterIndex::enclosingOpener(int pos)
+{
+	return findEnclosing(kBrackets, pos);
+}
+
+int TeXDelimiterIndex::matchingEnvironment(int pos)
+{
+	int blockNumber;
+	int index = delimiterAt(kEnvironments, pos, blockNumber);
+	return (index < 0 ? -1 : findPartner(kEnvironments, blockNumber, index));
+}
+
+int TeXDelimiterIndex::enclosingEnvironment(int pos)
+{
+	return findEnclosing(kEnvironments, pos);
+}
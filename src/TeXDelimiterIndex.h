@@ -0,0 +1,134 @@
+/*
+	This is part of TeXworks, an environment for working with TeX documents
+	Copyright (C) 2007-2012  Jonathan Kew, Stefan Löffler, Charlie Sharpsteen
+
+	This program is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	For links to further information, or to contact the authors,
+	see <http://www.tug.org/texworks/>.
+*/
+
+#ifndef TeXDelimiterIndex_H
+#define TeXDelimiterIndex_H
+
+#include <QObject>
+#include <QVector>
+#include <QString>
+
+class QTextDocument;
+class QTextBlock;
+
+// Index of the delimiters of a document: the character pairs configured in
+// delimiter-pairs.txt (see TWUtils::readConfig) and \begin/\end commands.
+// It is kept up to date block by block as the document changes. Besides the
+// delimiters of each block, it keeps a tree of per-block nesting summaries,
+// so that finding the partner of a delimiter takes O(log n) steps (plus a
+// scan of the two blocks involved), independent of the distance between
+// them and without any recursion.
+// Brackets of all pairs are counted together, and those in between are not
+// checked against each other, e.g., "{" matches "}" in "{ ( ] }", which a
+// strict check would reject.
+class TeXDelimiterIndex : public QObject
+{
+	Q_OBJECT
+
+public:
+	// returns the index of document, creating it if needed
+	static TeXDelimiterIndex *forDocument(QTextDocument *document);
+
+	// return document positions, or -1 if there is no such delimiter
+	// the delimiter matching the one at pos
+	int matchingDelimiter(int pos);
+	// the innermost opening delimiter before pos that is still open at pos
+	int enclosingOpener(int pos);
+	// the \begin or \end (i.e., its backslash) matching the command around pos
+	int matchingEnvironment(int pos);
+	// the \begin of the innermost environment enclosing pos
+	int enclosingEnvironment(int pos);
+
+private slots:
+	void contentsChange(int position, int charsRemoved, int charsAdded);
+
+private:
+	TeXDelimiterIndex(QTextDocument *document);
+
+	typedef enum {
+		kBrackets, kEnvironments, kNumChannels
+	} Channel;
+
+	class Delimiter
+	{
+	public:
+		int		offset;		// in the block
+		int		length;
+		bool	opening;
+		QChar	ch;				// for brackets
+		QString	environment;	// for \begin and \end
+	};
+
+	// nesting summary of a sequence of delimiters, counting openers as +1 and
+	// closers as -1
+	class Depth
+	{
+	public:
+		Depth() : net(0), minPrefix(0), maxSuffix(0) { }
+		Depth(const Depth& first, const Depth& second);
+
+		int	net;		// the sum
+		int	minPrefix;	// the smallest sum of a prefix (<= 0)
+		int	maxSuffix;	// the largest sum of a suffix (>= 0)
+	};
+
+	class Block
+	{
+	public:
+		QString	text;	// to tell format changes from edits
+		QVector<Delimiter>	delimiters[kNumChannels];
+		Depth	depth[kNumChannels];
+	};
+
+	// binary tree over the block summaries of one channel
+	class DepthTree
+	{
+	public:
+		void build(const QVector<Block>& blocks, Channel channel);
+		void update(int blockNumber, const Depth& depth);
+		// the first block from blockNumber on (or the last up to blockNumber)
+		// where the nesting level, starting at level, drops below 0 (or rises
+		// above 0, when going backwards); level is updated up to that block
+		int findForward(int blockNumber, int& level) const;
+		int findBackward(int blockNumber, int& level) const;
+
+	private:
+		int findForward(int node, int first, int last, int blockNumber, int& level) const;
+		int findBackward(int node, int first, int last, int blockNumber, int& level) const;
+
+		QVector<Depth>	nodes;	// nodes[1] is the root, node i has children 2i and 2i + 1
+		int	numLeaves;
+	};
+
+	static Block parseBlock(const QTextBlock& block);
+	void update();
+	int findPartner(Channel channel, int blockNumber, int index);
+	int findEnclosing(Channel channel, int pos);
+	int delimiterAt(Channel channel, int pos, int& blockNumber) const;
+
+	QTextDocument	*doc;
+	QVector<Block>	blocks;
+	DepthTree	trees[kNumChannels];
+	bool	treesValid;
+	QVector<int>	changedBlocks;	// to be updated in the trees
+};
+
+#endif
@@ -22,10 +22,10 @@
 #include "TeXDocks.h"
 
 #include "TeXDocument.h"
+#include "TWTagsModel.h"
 
-#include <QTreeWidget>
+#include <QTreeView>
 #include <QHeaderView>
-#include <QScrollBar>
 #include <QDomNode>
 
 TeXDock::TeXDock(const QString& title, TeXDocument *doc)
@@ -49,16 +49,14 @@ void TeXDock::myVisibilityChanged(bool visible)
 //////////////// TAGS ////////////////
 
 TagsDock::TagsDock(TeXDocument *doc)
-	: TeXDock(tr("Tags"), doc)
+	: TeXDock(tr("Tags"), doc), model(NULL)
 {
 	setObjectName("tags");
 	setAllowedAreas(Qt::LeftDockWidgetArea | Qt::RightDockWidgetArea);
-	tree = new TeXDockTreeWidget(this);
+	tree = new TeXDockTreeView(this);
 	tree->header()->hide();
 	tree->setHorizontalScrollMode(QAbstractItemView::ScrollPerPixel);
 	setWidget(tree);
-	connect(doc, SIGNAL(tagListUpdated()), this, SLOT(listChanged()));
-	saveScrollValue = 0;
 }
 
 TagsDock::~TagsDock()
@@ -67,92 +65,50 @@ TagsDock::~TagsDock()
 
 void TagsDock::fillInfo()
 {
-	disconnect(tree, SIGNAL(itemSelectionChanged()), this, SLOT(followTagSelection()));
-	disconnect(tree, SIGNAL(itemActivated(QTreeWidgetItem*, int)), this, SLOT(followTagSelection()));
-	disconnect(tree, SIGNAL(itemClicked(QTreeWidgetItem*, int)), this, SLOT(followTagSelection()));
-	tree->clear();
-	const QList<TeXDocument::Tag>& tags = document->getTags();
-	if (tags.size() > 0) {
-		QTreeWidgetItem *item = 0, *bmItem = 0;
-		QTreeWidgetItem *bookmarks = new QTreeWidgetItem(tree);
-		bookmarks->setText(0, tr("Bookmarks"));
-		bookmarks->setFlags(Qt::ItemIsEnabled);
-		bookmarks->setForeground(0, Qt::blue);
-		tree->expandItem(bookmarks);
-		QTreeWidgetItem *outline = new QTreeWidgetItem(tree, bookmarks);
-		outline->setText(0, tr("Outline"));
-		outline->setFlags(Qt::ItemIsEnabled);
-		outline->setForeground(0, Qt::blue);
-		tree->expandItem(outline);
-		for (int index = 0; index < tags.size(); ++index) {
-			const TeXDocument::Tag& bm = tags[index];
-			if (bm.level < 1) {
-				bmItem = new QTreeWidgetItem(bookmarks, QTreeWidgetItem::UserType);
-				bmItem->setText(0, bm.text);
-				bmItem->setText(1, QString::number(index));
-			}
-			else  {
-				while (item != 0 && item->type() >= QTreeWidgetItem::UserType + bm.level)
-					item = item->parent();
-				if (item == 0)
-					item = new QTreeWidgetItem(outline, QTreeWidgetItem::UserType + bm.level);
-				else
-					item = new QTreeWidgetItem(item, QTreeWidgetItem::UserType + bm.level);
-				item->setText(0, bm.text);
-				item->setText(1, QString::number(index));
-				tree->expandItem(item);
-			}
-		}
-		if (bookmarks->childCount() == 0)
-			bookmarks->setHidden(true);
-		if (outline->childCount() == 0)
-			outline->setHidden(true);
-		if (saveScrollValue > 0) {
-			tree->verticalScrollBar()->setValue(saveScrollValue);
-			saveScrollValue = 0;
-		}
-		connect(tree, SIGNAL(itemSelectionChanged()), this, SLOT(followTagSelection()));
-		connect(tree, SIGNAL(itemActivated(QTreeWidgetItem*, int)), this, SLOT(followTagSelection()));
-		connect(tree, SIGNAL(itemClicked(QTreeWidgetItem*, int)), this, SLOT(followTagSelection()));
-	} else {
-		QTreeWidgetItem *item = new QTreeWidgetItem();
-		item->setText(0, tr("No tags"));
-		item->setFlags(item->flags() & ~(Qt::ItemIsEnabled | Qt::ItemIsSelectable));
-		tree->addTopLevelItem(item);
-	}
+	// from now on, the model follows the changes of the document's tags
+	model = new TWTagsModel(document->tagIndex(), this);
+	tree->setModel(model);
+	expandTags(QModelIndex(), 0, model->rowCount() - 1);
+	connect(model, SIGNAL(rowsInserted(const QModelIndex&, int, int)), this, SLOT(expandTags(const QModelIndex&, int, int)));
+	connect(tree->selectionModel(), SIGNAL(selectionChanged(const QItemSelection&, const QItemSelection&)), this, SLOT(followTagSelection()));
+	connect(tree, SIGNAL(activated(const QModelIndex&)), this, SLOT(followTagSelection()));
+	connect(tree, SIGNAL(clicked(const QModelIndex&)), this, SLOT(followTagSelection()));
 }
 
-void TagsDock::listChanged()
+// new entries are shown expanded, like the rest of the outline
+void TagsDock::expandTags(const QModelIndex& parent, int first, int last)
 {
-	saveScrollValue = tree->verticalScrollBar()->value();
-	tree->clear();
-	filled = false;
-	if (document && isVisible())
-		fillInfo();
+	for (int row = first; row <= last; ++row) {
+		QModelIndex index = model->index(row, 0, parent);
+		int children = model->rowCount(index);
+		if (children > 0) {
+			tree->expand(index);
+			expandTags(index, 0, children - 1);
+		}
+	}
 }
 
 void TagsDock::followTagSelection()
 {
-	QList<QTreeWidgetItem*> items = tree->selectedItems();
-	if (items.count() > 0) {
-		QTreeWidgetItem* item = items.first();
-		QString dest = item->text(1);
-		if (!dest.isEmpty())
-			document->goToTag(dest.toInt());
+	QModelIndexList selected = tree->selectionModel()->selectedIndexes();
+	if (selected.count() > 0) {
+		QTextCursor cursor = model->tagCursor(selected.first());
+		if (!cursor.isNull())
+			document->goToTag(cursor);
 	}
 }
 
-TeXDockTreeWidget::TeXDockTreeWidget(QWidget* parent)
-	: QTreeWidget(parent)
+TeXDockTreeView::TeXDockTreeView(QWidget* parent)
+	: QTreeView(parent)
 {
 	setIndentation(10);
 }
 
-TeXDockTreeWidget::~TeXDockTreeWidget()
+TeXDockTreeView::~TeXDockTreeView()
 {
 }
 
-QSize TeXDockTreeWidget::sizeHint() const
+QSize TeXDockTreeView::sizeHint() const
 {
 	return QSize(180, 300);
 }
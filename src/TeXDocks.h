@@ -23,14 +23,14 @@
 #define TEXDOCKS_H
 
 #include <QDockWidget>
-#include <QTreeWidget>
+#include <QTreeView>
 #include <QListWidget>
 #include <QScrollArea>
 
 class TeXDocument;
+class TWTagsModel;
 class QListWidget;
 class QTableWidget;
-class QTreeWidgetItem;
 
 class TeXDock : public QDockWidget
 {
@@ -60,27 +60,25 @@ public:
 	TagsDock(TeXDocument *doc = 0);
 	virtual ~TagsDock();
 
-public slots:
-	virtual void listChanged();
-
 protected:
 	virtual void fillInfo();
 
 private slots:
 	void followTagSelection();
+	void expandTags(const QModelIndex& parent, int first, int last);
 
 private:
-	QTreeWidget *tree;
-	int saveScrollValue;
+	QTreeView *tree;
+	TWTagsModel *model;
 };
 
-class TeXDockTreeWidget : public QTreeWidget
+class TeXDockTreeView : public QTreeView
 {
 	Q_OBJECT
 
 public:
-	TeXDockTreeWidget(QWidget* parent);
-	virtual ~TeXDockTreeWidget();
+	TeXDockTreeView(QWidget* parent);
+	virtual ~TeXDockTreeView();
 
 	virtual QSize sizeHint() const;
 };
@@ -21,8 +21,10 @@
 
 #include "TeXDocument.h"
 #include "TeXHighlighter.h"
+#include "TeXDelimiterIndex.h"
 #include "TeXDocks.h"
 #include "FindDialog.h"
+#include "TWProjectSearch.h"
 #include "TemplateDialog.h"
 #include "TWApp.h"
 #include "TWUtils.h"
@@ -71,6 +73,9 @@
 
 const int kHardWrapDefaultWidth = 64;
 
+// minimum time between two sync requests sent while auto-following (in ms)
+const int kAutoFollowInterval = 100;
+
 QList<TeXDocument*> TeXDocument::docList;
 
 TeXDocument::TeXDocument()
@@ -102,6 +107,13 @@ void TeXDocument::init()
 	process = NULL;
 	highlighter = NULL;
 	pHunspell = NULL;
+	tags = new TWTagIndex(this);
+	connect(tags, SIGNAL(tagsChanged()), this, SIGNAL(tagListUpdated()));
+	autoFollowLine = -1;
+	autoFollowTimer.setSingleShot(true);
+	autoFollowTimer.setInterval(kAutoFollowInterval);
+	visibleLinesTimer.setSingleShot(true);
+	visibleLinesTimer.setInterval(kAutoFollowInterval);
 #ifdef Q_WS_WIN
 	lineEndings = kLineEnd_CRLF;
 #else
@@ -205,6 +217,7 @@ void TeXDocument::init()
 	connect(actionToggle_Case, SIGNAL(triggered()), this, SLOT(toggleCase()));
 
 	connect(actionBalance_Delimiters, SIGNAL(triggered()), this, SLOT(balanceDelimiters()));
+	connect(actionGo_to_Matching_Environment, SIGNAL(triggered()), this, SLOT(goToMatchingEnvironment()));
 
 	connect(textEdit->document(), SIGNAL(modificationChanged(bool)), this, SLOT(setWindowModified(bool)));
 	connect(textEdit->document(), SIGNAL(modificationChanged(bool)), this, SLOT(maybeEnableSaveAndRevert(bool)));
@@ -212,7 +225,15 @@ void TeXDocument::init()
 	connect(textEdit, SIGNAL(cursorPositionChanged()), this, SLOT(showCursorPosition()));
 	connect(textEdit, SIGNAL(selectionChanged()), this, SLOT(showCursorPosition()));
 	connect(textEdit, SIGNAL(syncClick(int)), this, SLOT(syncClick(int)));
+	connect(&autoFollowTimer, SIGNAL(timeout()), this, SLOT(autoFollowCursor()));
+	connect(actionAuto_Follow_Focus, SIGNAL(toggled(bool)), this, SLOT(autoFollowCursor()));
 	connect(this, SIGNAL(syncFromSource(const QString&, int, bool)), qApp, SIGNAL(syncPdf(const QString&, int, bool)));
+	// the visible lines change when scrolling, resizing or editing
+	connect(textEdit->verticalScrollBar(), SIGNAL(valueChanged(int)), &visibleLinesTimer, SLOT(start()));
+	connect(textEdit, SIGNAL(resized()), &visibleLinesTimer, SLOT(start()));
+	connect(textEdit->document(), SIGNAL(contentsChanged()), &visibleLinesTimer, SLOT(start()));
+	connect(&visibleLinesTimer, SIGNAL(timeout()), this, SLOT(emitVisibleLines()));
+	connect(this, SIGNAL(visibleLinesChanged(const QString&, int, int)), qApp, SIGNAL(sourceLinesVisible(const QString&, int, int)));
 
 	connect(QApplication::clipboard(), SIGNAL(dataChanged()), this, SLOT(clipboardChanged()));
 	clipboardChanged();
@@ -273,7 +294,6 @@ void TeXDocument::init()
 	setLineNumbers(b);
 	
 	highlighter = new TeXHighlighter(textEdit->document(), this);
-	connect(textEdit, SIGNAL(rehighlight()), highlighter, SLOT(rehighlight()));
 
 	QStringList options = TeXHighlighter::syntaxOptions();
 
@@ -385,7 +405,6 @@ void TeXDocument::init()
 	dw->hide();
 	addDockWidget(Qt::LeftDockWidgetArea, dw);
 	menuShow->addAction(dw->toggleViewAction());
-	deferTagListChanges = false;
 
 	watcher = new QFileSystemWatcher(this);
 	connect(watcher, SIGNAL(fileChanged(const QString&)), this, SLOT(reloadIfChangedOnDisk()), Qt::QueuedConnection);
@@ -910,15 +929,35 @@ static const char* texshopSynonyms[] = {
 	NULL
 };
 
-QTextCodec *TeXDocument::scanForEncoding(const QString &peekStr, bool &hasMetadata, QString &reqName)
+QString TeXDocument::requestedEncoding(const QString &peekStr)
 {
 	// peek at the file for %!TEX encoding = ....
 	QRegExp re("% *!TEX +encoding *= *([^\\r\\n\\x2029]+)[\\r\\n\\x2029]", Qt::CaseInsensitive);
-	int pos = re.indexIn(peekStr);
+	if (re.indexIn(peekStr) < 0)
+		return QString();
+	return re.cap(1).trimmed();
+}
+
+QHash<QString, QTextCodec*> TeXDocument::encodingCodecs()
+{
+	QHash<QString, QTextCodec*> codecs;
+	foreach (const QByteArray& name, QTextCodec::availableCodecs())
+		codecs.insert(QString(name).toLower(), QTextCodec::codecForName(name));
+	for (int i = 0; texshopSynonyms[i] != NULL; i += 2) {
+		QString synonym = QString(texshopSynonyms[i]).toLower();
+		QTextCodec *codec = QTextCodec::codecForName(texshopSynonyms[i+1]);
+		if (codec != NULL && !codecs.contains(synonym))
+			codecs.insert(synonym, codec);
+	}
+	return codecs;
+}
+
+QTextCodec *TeXDocument::scanForEncoding(const QString &peekStr, bool &hasMetadata, QString &reqName)
+{
 	QTextCodec *reqCodec = NULL;
-	if (pos > -1) {
-		hasMetadata = true;
-		reqName = re.cap(1).trimmed();
+	reqName = requestedEncoding(peekStr);
+	hasMetadata = !reqName.isNull();
+	if (hasMetadata) {
 		reqCodec = QTextCodec::codecForName(reqName.toAscii());
 		if (reqCodec == NULL) {
 			static QHash<QString,QString> *synonyms = NULL;
@@ -931,8 +970,6 @@ QTextCodec *TeXDocument::scanForEncoding(const QString &peekStr, bool &hasMetada
 				reqCodec = QTextCodec::codecForName(synonyms->value(reqName.toLower()).toAscii());
 		}
 	}
-	else
-		hasMetadata = false;
 	return reqCodec;
 }
 
@@ -1028,12 +1065,12 @@ void TeXDocument::loadFile(const QString &fileName, bool asTemplate, bool inBack
 
 	QApplication::setOverrideCursor(Qt::WaitCursor);
 
-	deferTagListChanges = true;
-	tagListChanged = false;
+	// only mark the blocks for highlighting here; the highlighter does the
+	// visible ones first, and the rest (including the tags) when idle
+	tags->clear();
+	highlighter->setDeferHighlighting(true);
 	textEdit->setPlainText(fileContents);
-	deferTagListChanges = false;
-	if (tagListChanged)
-		emit tagListUpdated();
+	highlighter->setDeferHighlighting(false);
 
 	// Ensure the window is shown early (before setPlainText()).
 	// - this ensures it is shown before the PDF (if opening a new doc)
@@ -1044,11 +1081,15 @@ void TeXDocument::loadFile(const QString &fileName, bool asTemplate, bool inBack
 
 	{
 		// Try to work around QTBUG-20354
-		// It seems that adding additionalFormats (as is done automatically on
-		// setPlainText() by the syntax highlighter) can disturb the layouting
-		// process, leaving some blocks with size zero. This causes the
-		// corresponding lines to "disappear" and can even crash the application
-		// in connection with the "highlight current line" feature.
+		// It seems that adding additionalFormats (as is done by the syntax
+		// highlighter) can disturb the layouting process, leaving some blocks
+		// with size zero. This causes the corresponding lines to "disappear"
+		// and can even crash the application in connection with the
+		// "highlight current line" feature.
+		// Only the blocks on screen are checked (checking all of them would
+		// force the layout of the whole document), and broken blocks are laid
+		// out again individually rather than by resetting the text, which
+		// would also rehighlight everything.
 		QTextDocument * doc = textEdit->document();
 		Q_ASSERT(doc != NULL);
 		QAbstractTextDocumentLayout * docLayout = doc->documentLayout();
@@ -1057,18 +1098,16 @@ void TeXDocument::loadFile(const QString &fileName, bool asTemplate, bool inBack
 		int tries;
 		for (tries = 0; tries < 10; ++tries) {
 			bool isLayoutOK = true;
-			for (QTextBlock b = doc->firstBlock(); b.isValid(); b = b.next()) {
-				if (docLayout->	blockBoundingRect(b).isEmpty()) {
+			int firstLine, lastLine;
+			visibleLines(firstLine, lastLine);
+			QTextBlock b = doc->findBlockByNumber(firstLine - 1);
+			for (; b.isValid() && b.blockNumber() < lastLine; b = b.next()) {
+				if (docLayout->blockBoundingRect(b).isEmpty()) {
 					isLayoutOK = false;
-					break;
+					doc->markContentsDirty(b.position(), b.length());
 				}
 			}
 			if (isLayoutOK) break;
-			// Re-setting the document content naturally triggers a relayout
-			// (also a rehighlight). Note that layouting only works sensibly
-			// once show() was called, or else there is no valid widget geometry
-			// to act as bounding box.
-			doc->setPlainText(doc->toPlainText());
 			QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
 		}
 		if (tries >= 10) {
@@ -1527,8 +1566,56 @@ void TeXDocument::showCursorPosition()
 	int total = textEdit->document()->blockCount();
 	int col = cursor.position() - textEdit->document()->findBlock(cursor.selectionStart()).position();
 	lineNumberLabel->setText(tr("Line %1 of %2; col %3").arg(line).arg(total).arg(col));
-	if (actionAuto_Follow_Focus->isChecked())
-		emit syncFromSource(curFile, line, false);
+	autoFollowCursor();
+}
+
+void TeXDocument::autoFollowCursor()
+{
+	if (!actionAuto_Follow_Focus->isChecked()) {
+		autoFollowLine = -1;
+		return;
+	}
+	// while the timer runs, cursor movements are coalesced; it sends the
+	// latest position when it fires
+	if (autoFollowTimer.isActive())
+		return;
+	QTextCursor cursor = textEdit->textCursor();
+	int line = textEdit->document()->findBlock(cursor.selectionStart()).blockNumber() + 1;
+	if (line == autoFollowLine)
+		return;
+	autoFollowLine = line;
+	emit syncFromSource(curFile, line, false);
+	autoFollowTimer.start();
+}
+
+QList<QVariant> TeXDocument::syncLinesToRects(const QString& sourceFile, int firstLine, int lastLine)
+{
+	if (pdfDoc == NULL)
+		return QList<QVariant>();
+	return pdfDoc->syncLinesToRects(sourceFile, firstLine, lastLine);
+}
+
+QList<QVariant> TeXDocument::syncPageToLines(int pageIndex)
+{
+	if (pdfDoc == NULL)
+		return QList<QVariant>();
+	return pdfDoc->syncPageToLines(pageIndex);
+}
+
+void TeXDocument::visibleLines(int& firstLine, int& lastLine) const
+{
+	QRect r = textEdit->viewport()->rect();
+	firstLine = textEdit->cursorForPosition(r.topLeft()).blockNumber() + 1;
+	lastLine = textEdit->cursorForPosition(r.bottomRight()).blockNumber() + 1;
+}
+
+void TeXDocument::emitVisibleLines()
+{
+	if (isUntitled)
+		return;
+	int firstLine, lastLine;
+	visibleLines(firstLine, lastLine);
+	emit visibleLinesChanged(curFile, firstLine, lastLine);
 }
 
 void TeXDocument::showLineEndingSetting()
@@ -1890,29 +1977,42 @@ void TeXDocument::insertText(const QString& text)
 
 void TeXDocument::balanceDelimiters()
 {
-	const QString text = textEdit->toPlainText();
+	TeXDelimiterIndex *index = TeXDelimiterIndex::forDocument(textEdit->document());
 	QTextCursor cursor = textEdit->textCursor();
-	int openPos = TWUtils::findOpeningDelim(text, cursor.selectionStart());
-	if (openPos >= 0 && openPos < text.length() - 1) {
-		do {
-			int closePos = TWUtils::balanceDelim(text, openPos + 1, TWUtils::closerMatching(text[openPos]), 1);
-			if (closePos < 0)
-				break;
-			if (closePos >= cursor.selectionEnd()) {
-				cursor.setPosition(openPos);
-				cursor.setPosition(closePos + 1, QTextCursor::KeepAnchor);
-				textEdit->setTextCursor(cursor);
-				return;
-			}
-			if (openPos > 0)
-				openPos = TWUtils::findOpeningDelim(text, openPos - 1);
-			else
-				break;
-		} while (openPos >= 0);
+	// widen the selection to the innermost pair of delimiters enclosing it
+	int openPos = index->enclosingOpener(cursor.selectionStart());
+	while (openPos >= 0) {
+		int closePos = index->matchingDelimiter(openPos);
+		if (closePos < 0)
+			break;
+		if (closePos >= cursor.selectionEnd()) {
+			cursor.setPosition(openPos);
+			cursor.setPosition(closePos + 1, QTextCursor::KeepAnchor);
+			textEdit->setTextCursor(cursor);
+			return;
+		}
+		openPos = index->enclosingOpener(openPos);
 	}
 	QApplication::beep();
 }
 
+void TeXDocument::goToMatchingEnvironment()
+{
+	TeXDelimiterIndex *index = TeXDelimiterIndex::forDocument(textEdit->document());
+	QTextCursor cursor = textEdit->textCursor();
+	// from a \begin or \end to its partner, otherwise to the \begin of the
+	// environment the cursor is in
+	int pos = index->matchingEnvironment(cursor.position());
+	if (pos < 0)
+		pos = index->enclosingEnvironment(cursor.position());
+	if (pos < 0) {
+		QApplication::beep();
+		return;
+	}
+	cursor.setPosition(pos);
+	textEdit->setTextCursor(cursor);
+}
+
 void TeXDocument::doHardWrapDialog()
 {
 	HardWrapDialog dlg(this);
@@ -2087,6 +2187,27 @@ void TeXDocument::setAutoIndentMode(const QString& mode)
 	}
 }
 
+// turns the matches of a TWTextSearch into search results
+class SearchResultCollector : public TWTextMatchReceiver
+{
+public:
+	SearchResultCollector(TeXDocument *document)
+		: doc(document)
+		{ }
+
+	virtual bool foundMatches(const QTextBlock& block, const QList<TWTextMatch>& matches)
+		{
+			int blockStart = block.position();
+			foreach (const TWTextMatch& match, matches)
+				results.append(SearchResult(doc, block.blockNumber() + 1, match.start - blockStart,
+											match.start + match.length - blockStart));
+			return true;
+		}
+
+	TeXDocument	*doc;
+	QList<SearchResult>	results;
+};
+
 void TeXDocument::doFindAgain(bool fromDialog)
 {
 	QSETTINGS_OBJECT(settings);
@@ -2108,50 +2229,23 @@ void TeXDocument::doFindAgain(bool fromDialog)
 		}
 	}
 
-	if (fromDialog && (settings.value("searchFindAll").toBool() || settings.value("searchAllFiles").toBool())) {
-		bool singleFile = true;
-		QList<SearchResult> results;
-		flags &= ~QTextDocument::FindBackward;
-		int docListIndex = 0;
-		TeXDocument* theDoc = this;
-		while (1) {
-			QTextCursor curs(theDoc->textDoc());
-			curs.movePosition(QTextCursor::End);
-			int rangeStart = 0;
-			int rangeEnd = curs.position();
-			while (1) {
-				curs = doSearch(theDoc->textDoc(), searchText, regex, flags, rangeStart, rangeEnd);
-				if (curs.isNull())
-					break;
-				int blockStart = curs.block().position();
-				results.append(SearchResult(theDoc, curs.blockNumber() + 1,
-								curs.selectionStart() - blockStart, curs.selectionEnd() - blockStart));
-				if ((flags & QTextDocument::FindBackward) != 0)
-					rangeEnd = curs.selectionStart();
-				else
-					rangeStart = curs.selectionEnd();
-			}
+	if (fromDialog && settings.value("searchAllFiles").toBool()) {
+		// the project's files are searched in the background
+		TWProjectSearch::start(this, TWTextSearch(searchText, regex != NULL, flags & ~QTextDocument::FindBackward));
+	}
+	else if (fromDialog && settings.value("searchFindAll").toBool()) {
+		// all matches are collected in a single pass over the document
+		SearchResultCollector collector(this);
+		TWTextSearch(searchText, regex != NULL, flags & ~QTextDocument::FindBackward)
+			.findAll(textEdit->document(), collector);
+		const QList<SearchResult>& results = collector.results;
 
-			if (settings.value("searchAllFiles").toBool() == false)
-				break;
-			// go to next document
-		next_doc:
-			if (docList[docListIndex] == theDoc)
-				docListIndex++;
-			if (docListIndex == docList.count())
-				break;
-			theDoc = docList[docListIndex];
-			if (theDoc == this)
-				goto next_doc;
-			singleFile = false;
-		}
-		
 		if (results.count() == 0) {
 			qApp->beep();
 			statusBar()->showMessage(tr("Not found"), kStatusMessageDuration);
 		}
 		else {
-			SearchResults::presentResults(searchText, results, this, singleFile);
+			SearchResults::presentResults(searchText, results, this, true);
 			statusBar()->showMessage(tr("Found %n occurrence(s)", "", results.count()), kStatusMessageDuration);
 		}
 	}
@@ -2200,6 +2294,16 @@ void TeXDocument::doReplaceAgain()
 	doReplace(ReplaceDialog::ReplaceOne);
 }
 
+// the text of a selection as returned by QTextDocument::toPlainText()
+static QString plainText(const QTextCursor& curs)
+{
+	QString text = curs.selectedText();
+	text.replace(QChar::ParagraphSeparator, QChar('\n'));
+	text.replace(QChar::LineSeparator, QChar('\n'));
+	text.replace(QChar::Nbsp, QChar(' '));
+	return text;
+}
+
 void TeXDocument::doReplace(ReplaceDialog::DialogCode mode)
 {
 	QSETTINGS_OBJECT(settings);
@@ -2308,8 +2412,7 @@ void TeXDocument::doReplace(ReplaceDialog::DialogCode mode)
 			// do replacement
 			QString target;
 			if (regex != NULL)
-				target = textEdit->document()->toPlainText()
-							.mid(curs.selectionStart(), curs.selectionEnd() - curs.selectionStart()).replace(*regex, replacement);
+				target = plainText(curs).replace(*regex, replacement);
 			else
 				target = replacement;
 			curs.insertText(target);
@@ -2343,99 +2446,106 @@ void TeXDocument::doReplace(ReplaceDialog::DialogCode mode)
 		delete regex;
 }
 
+// collects the matches of a TWTextSearch together with their replacements
+class ReplacementCollector : public TWTextMatchReceiver
+{
+public:
+	ReplacementCollector(QTextDocument *document, const QRegExp *regex, const QString& replacement)
+		: doc(document), replacementText(replacement)
+		{
+			if (regex != NULL)
+				pattern = *regex;
+		}
+
+	virtual bool foundMatches(const QTextBlock& block, const QList<TWTextMatch>& found)
+		{
+			const QString text = block.text();
+			int blockStart = block.position();
+			foreach (const TWTextMatch& match, found) {
+				matches << match;
+				if (pattern.isEmpty())
+					targets << replacementText;
+				else {
+					QString matchedText;
+					if (match.start + match.length <= blockStart + text.length())
+						matchedText = text.mid(match.start - blockStart, match.length);
+					else {
+						QTextCursor curs(doc);
+						curs.setPosition(match.start);
+						curs.setPosition(match.start + match.length, QTextCursor::KeepAnchor);
+						matchedText = plainText(curs);
+					}
+					targets << matchedText.replace(pattern, replacementText);
+				}
+			}
+			return true;
+		}
+
+	QTextDocument	*doc;
+	QRegExp	pattern;
+	QString	replacementText;
+	QList<TWTextMatch>	matches;
+	QStringList	targets;
+};
+
 int TeXDocument::doReplaceAll(const QString& searchText, QRegExp* regex, const QString& replacement,
 								QTextDocument::FindFlags flags, int rangeStart, int rangeEnd)
 {
-	QTextCursor searchRange = textCursor();
-	searchRange.select(QTextCursor::Document);
+	QTextDocument *doc = textEdit->document();
 	if (rangeStart < 0)
-		rangeStart = searchRange.selectionStart();
+		rangeStart = 0;
 	if (rangeEnd < 0)
-		rangeEnd = searchRange.selectionEnd();
-		
-	int replacements = 0;
-	bool first = true;
-	while (1) {
-		QTextCursor curs = doSearch(textEdit->document(), searchText, regex, flags, rangeStart, rangeEnd);
-		if (curs.isNull()) {
-			if (!first)
-				searchRange.endEditBlock();
-			break;
-		}
-		if (first) {
-			searchRange.beginEditBlock();
-			first = false;
-		}
-		QString target;
-		int oldLen = curs.selectionEnd() - curs.selectionStart();
-		if (regex != NULL)
-			target = textEdit->document()->toPlainText().mid(curs.selectionStart(), oldLen).replace(*regex, replacement);
-		else
-			target = replacement;
-		int newLen = target.length();
-		if ((flags & QTextDocument::FindBackward) != 0)
-			rangeEnd = curs.selectionStart();
-		else {
-			rangeStart = curs.selectionEnd() - oldLen + newLen;
-			rangeEnd += newLen - oldLen;
-		}
-		searchRange.setPosition(curs.selectionStart());
-		searchRange.setPosition(curs.selectionEnd(), QTextCursor::KeepAnchor);
-		searchRange.insertText(target);
-		++replacements;
-	}
-	if (!first) {
-		searchRange.setPosition(rangeStart);
-		textEdit->setTextCursor(searchRange);
-	}
-	return replacements;
+		rangeEnd = doc->characterCount() - 1;
+
+	// all matches and their replacements are determined in a single pass
+	// before the document is changed
+	ReplacementCollector collector(doc, regex, replacement);
+	TWTextSearch(searchText, regex != NULL, flags & ~QTextDocument::FindBackward)
+		.findAll(doc, collector, rangeStart, rangeEnd);
+	const QList<TWTextMatch>& matches = collector.matches;
+	if (matches.isEmpty())
+		return 0;
+
+	// apply the replacements as one undo step, from the last to the first so
+	// the positions of the remaining ones stay valid; the changed blocks are
+	// only highlighted (and their tags updated) once everything is replaced
+	QTextCursor curs(doc);
+	highlighter->setDeferHighlighting(true);
+	beginTagListChanges();
+	curs.beginEditBlock();
+	QTextCursor lastReplacement;
+	for (int i = matches.count() - 1; i >= 0; --i) {
+		curs.setPosition(matches[i].start);
+		curs.setPosition(matches[i].start + matches[i].length, QTextCursor::KeepAnchor);
+		curs.insertText(collector.targets[i]);
+		if (lastReplacement.isNull())
+			lastReplacement = curs;	// follows the earlier replacements
+	}
+	curs.endEditBlock();
+	endTagListChanges();
+	highlighter->setDeferHighlighting(false);
+
+	// leave the cursor after the last replacement (or at the start of the
+	// range when searching backwards)
+	if ((flags & QTextDocument::FindBackward) != 0)
+		curs.setPosition(rangeStart);
+	else
+		curs.setPosition(lastReplacement.position());
+	textEdit->setTextCursor(curs);
+	return matches.count();
 }
 
 QTextCursor TeXDocument::doSearch(QTextDocument *theDoc, const QString& searchText, const QRegExp *regex, QTextDocument::FindFlags flags, int s, int e)
 {
-	QTextCursor curs;
-	const QString& docText = theDoc->toPlainText();
-	
-	if ((flags & QTextDocument::FindBackward) != 0) {
-		if (regex != NULL) {
-			// this doesn't seem to match \n or even \x2029 for newline
-			// curs = theDoc->find(*regex, e, flags);
-			int offset = regex->lastIndexIn(docText, e, QRegExp::CaretAtZero);
-			while (offset >= s && offset + regex->matchedLength() > e)
-				offset = regex->lastIndexIn(docText, offset - 1, QRegExp::CaretAtZero);
-			if (offset >= s) {
-				curs = QTextCursor(theDoc);
-				curs.setPosition(offset);
-				curs.setPosition(offset + regex->matchedLength(), QTextCursor::KeepAnchor);
-			}
-		}
-		else {
-			curs = theDoc->find(searchText, e, flags);
-			if (!curs.isNull()) {
-				if (curs.selectionEnd() > e)
-					curs = theDoc->find(searchText, curs, flags);
-				if (curs.selectionStart() < s)
-					curs = QTextCursor();
-			}
-		}
-	}
-	else {
-		if (regex != NULL) {
-			// this doesn't seem to match \n or even \x2029 for newline
-			// curs = theDoc->find(*regex, s, flags);
-			int offset = regex->indexIn(docText, s, QRegExp::CaretAtZero);
-			if (offset >= 0) {
-				curs = QTextCursor(theDoc);
-				curs.setPosition(offset);
-				curs.setPosition(offset + regex->matchedLength(), QTextCursor::KeepAnchor);
-			}
-		}
-		else {
-			curs = theDoc->find(searchText, s, flags);
-		}
-		if (curs.selectionEnd() > e)
-			curs = QTextCursor();
-	}
+	// regular expressions are matched block by block unless they may span
+	// lines, so the document's text is not copied on every search
+	TWTextMatch match = TWTextSearch(searchText, regex != NULL, flags).find(theDoc, s, e);
+	if (match.start < 0)
+		return QTextCursor();
+
+	QTextCursor curs(theDoc);
+	curs.setPosition(match.start);
+	curs.setPosition(match.start + match.length, QTextCursor::KeepAnchor);
 	return curs;
 }
 
@@ -2954,45 +3064,10 @@ void TeXDocument::findRootFilePath()
 		rootFilePath = fileInfo.canonicalFilePath();
 }
 
-void TeXDocument::addTag(const QTextCursor& cursor, int level, const QString& text)
+void TeXDocument::goToTag(const QTextCursor& cursor)
 {
-	int index = 0;
-	while (index < tags.size()) {
-		if (tags[index].cursor.selectionStart() > cursor.selectionStart())
-			break;
-		++index;
-	}
-	tags.insert(index, Tag(cursor, level, text));
-}
-
-int TeXDocument::removeTags(int offset, int len)
-{
-	int removed = 0;
-	for (int index = tags.count() - 1; index >= 0; --index) {
-		if (tags[index].cursor.selectionStart() < offset)
-			break;
-		if (tags[index].cursor.selectionStart() < offset + len) {
-			tags.removeAt(index);
-			++removed;
-		}
-	}
-	return removed;
-}
-
-void TeXDocument::goToTag(int index)
-{
-	if (index < tags.count()) {
-		textEdit->setTextCursor(tags[index].cursor);
-		textEdit->setFocus(Qt::OtherFocusReason);
-	}
-}
-
-void TeXDocument::tagsChanged()
-{
-	if (deferTagListChanges)
-		tagListChanged = true;
-	else
-		emit tagListUpdated();
+	textEdit->setTextCursor(cursor);
+	textEdit->setFocus(Qt::OtherFocusReason);
 }
 
 void TeXDocument::removeAuxFiles()
@@ -25,16 +25,19 @@
 #include "TWScriptable.h"
 
 #include <QList>
+#include <QHash>
 #include <QRegExp>
 #include <QProcess>
 #include <QDateTime>
 #include <QSignalMapper>
+#include <QTimer>
 
 #include "ui_TeXDocument.h"
 
 #include "FindDialog.h"
 #include "TWApp.h"
 #include "ClickableLabel.h"
+#include "TWTagIndex.h"
 
 #include <hunspell.h>
 
@@ -88,29 +91,34 @@ public:
 	int selectionLength() { return textCursor().selectionEnd() - textCursor().selectionStart(); }
 	
 	QString spellcheckLanguage() const;
+	const QString& getRootFilePath();
+	// the encoding named by %!TEX encoding = ... metadata, or a null string
+	static QString requestedEncoding(const QString &peekStr);
+	// the codecs of the encoding names understood in such metadata, by
+	// lower-case name; for reading files in worker threads, which must not
+	// call QTextCodec::codecForName()
+	static QHash<QString, QTextCodec*> encodingCodecs();
 
 	PDFDocument* pdfDocument()
 		{ return pdfDoc; }
+	// batch SyncTeX queries on the preview (see TWScriptAPI)
+	Q_INVOKABLE QList<QVariant> syncLinesToRects(const QString& sourceFile, int firstLine, int lastLine);
+	Q_INVOKABLE QList<QVariant> syncPageToLines(int pageIndex);
+	// the (1-based) first and last line visible in the editor
+	void visibleLines(int& firstLine, int& lastLine) const;
 
-	void addTag(const QTextCursor& cursor, int level, const QString& text);
-	int removeTags(int offset, int len);
-	void goToTag(int index);
-	void tagsChanged();
+	TWTagIndex* tagIndex() const
+		{ return tags; }
+	void goToTag(const QTextCursor& cursor);
+	// collect tag changes and emit tagListUpdated() only once at the end
+	void beginTagListChanges()
+		{ tags->beginChanges(); }
+	void endTagListChanges()
+		{ tags->endChanges(); }
 
 	bool isModified() const { return textEdit->document()->isModified(); }
 	void setModified(const bool m = true) { textEdit->document()->setModified(m); }
 
-	class Tag {
-	public:
-		QTextCursor	cursor;
-		int			level;
-		QString		text;
-		Tag(const QTextCursor& curs, int lvl, const QString& txt)
-			: cursor(curs), level(lvl), text(txt) { };
-	};
-	const QList<Tag> getTags() const
-		{ return tags; }
-
 	Q_PROPERTY(QString selection READ selectedText STORED false);
 	Q_PROPERTY(int selectionStart READ selectionStart STORED false);
 	Q_PROPERTY(int selectionLength READ selectionLength STORED false);
@@ -124,6 +132,7 @@ public:
 	
 signals:
 	void syncFromSource(const QString&, int, bool);
+	void visibleLinesChanged(const QString&, int, int);
 	void activatedWindow(QWidget*);
 	void tagListUpdated();
 	void asyncFlashStatusBarMessage(const QString & msg, const int timeout = 0);
@@ -162,6 +171,7 @@ public slots:
 	void toLowercase();
 	void toggleCase();
 	void balanceDelimiters();
+	void goToMatchingEnvironment();
 	void doHardWrapDialog();
 	void setLineNumbers(bool displayNumbers);
 	void setWrapLines(bool wrap);
@@ -200,6 +210,8 @@ private slots:
 	void updateWindowMenu();
 	void updateEngineList();
 	void showCursorPosition();
+	void autoFollowCursor();
+	void emitVisibleLines();
 	void editMenuAboutToShow();
 	void processStandardOutput();
 	void processError(QProcess::ProcessError error);
@@ -245,7 +257,6 @@ private:
 	void goToLine(int lineNo, int selStart = -1, int selEnd = -1);
 	void updateTypesettingAction();
 	void findRootFilePath();
-	const QString& getRootFilePath();
 	void maybeCenterSelection(int oldScrollValue = -1);
 	void presentResults(const QList<SearchResult>& results);
 	void showLineEndingSetting();
@@ -274,6 +285,13 @@ private:
 	
 	QSignalMapper dictSignalMapper;
 
+	// auto-follow sync requests are sent at most once per kAutoFollowInterval,
+	// and only when the cursor moved to a different line
+	QTimer autoFollowTimer;
+	int autoFollowLine;
+	// scrolling is reported once it pauses for kAutoFollowInterval
+	QTimer visibleLinesTimer;
+
 	QComboBox *engine;
 	QProcess *process;
 	bool keepConsoleOpen;
@@ -287,9 +305,7 @@ private:
 
 	QFileSystemWatcher *watcher;
 	
-	QList<Tag>	tags;
-	bool deferTagListChanges;
-	bool tagListChanged;
+	TWTagIndex	*tags;
 
 	QTextCursor	dragSavedCursor;
 
@@ -22,6 +22,11 @@
 #include <QRegExp>
 #include <QTextCodec>
 #include <QTextCursor>
+#include <QTextBlock>
+#include <QTextDocument>
+#include <QTextLayout>
+#include <QVarLengthArray>
+#include <QTime>
 
 #include "TeXHighlighter.h"
 #include "TeXDocument.h"
@@ -29,6 +34,16 @@
 
 #include <limits.h> // for INT_MAX
 
+// the user data of blocks that still need highlighting
+class PendingBlockData : public QTextBlockUserData
+{
+};
+
+static bool isPending(const QTextBlock& block)
+{
+	return dynamic_cast<PendingBlockData*>(block.userData()) != NULL;
+}
+
 QList<TeXHighlighter::HighlightingSpec> *TeXHighlighter::syntaxRules = NULL;
 QList<TeXHighlighter::TagPattern> *TeXHighlighter::tagPatterns = NULL;
 
@@ -39,10 +54,27 @@ TeXHighlighter::TeXHighlighter(QTextDocument *parent, TeXDocument *texDocument)
 	, isTagging(true)
 	, pHunspell(NULL)
 	, spellingCodec(NULL)
+	, deferHighlighting(false)
+	, lazyHighlightBlock(0)
 {
 	loadPatterns();
 	spellFormat.setUnderlineStyle(QTextCharFormat::SpellCheckUnderline);
 	spellFormat.setUnderlineColor(Qt::red);
+
+	spellRequestTimer.setSingleShot(true);
+	spellRequestTimer.setInterval(0);
+	connect(&spellRequestTimer, SIGNAL(timeout()), this, SLOT(requestSpellChecks()));
+	lazyHighlightTimer.setSingleShot(true);
+	lazyHighlightTimer.setInterval(0);
+	connect(&lazyHighlightTimer, SIGNAL(timeout()), this, SLOT(highlightPendingBlocks()));
+	TWSpellChecker *spellChecker = TWSpellChecker::instance();
+	connect(spellChecker, SIGNAL(wordsChecked(QObject*, int)), this, SLOT(spellChecksDone(QObject*, int)));
+	connect(spellChecker, SIGNAL(wordIgnored(Hunhandle*, const QString&)), this, SLOT(wordIgnored(Hunhandle*, const QString&)));
+}
+
+TeXHighlighter::~TeXHighlighter()
+{
+	TWSpellChecker::instance()->cancelRequests(this);
 }
 
 void TeXHighlighter::spellCheckRange(const QString &text, int index, int limit, const QTextCharFormat &spellFormat)
@@ -56,32 +88,96 @@ void TeXHighlighter::spellCheckRange(const QString &text, int index, int limit,
 				end = limit;
 			if (start < end) {
 				QString word = text.mid(start, end - start);
-				int spellResult = Hunspell_spell(pHunspell, spellingCodec->fromUnicode(word).data());
-				if (spellResult == 0)
+#if QT_VERSION >= 0x040600	/* rehighlightBlock() is not available before 4.6 */
+				TWSpellChecker::WordStatus status = TWSpellChecker::instance()->cachedStatus(pHunspell, word);
+				if (status == TWSpellChecker::kMisspelled)
+					setFormat(start, end - start, spellFormat);
+				else if (status == TWSpellChecker::kUnknown) {
+					// not checked yet, or dropped from the cache again
+					if (!blockUncheckedWords.contains(word))
+						blockUncheckedWords << word;
+				}
+#else
+				if (!TWSpellChecker::instance()->isWordCorrect(pHunspell, spellingCodec, word))
 					setFormat(start, end - start, spellFormat);
+#endif
 			}
 		}
 		index = end;
 	}
 }
 
+// Keeps track of the next match of each of a list of patterns in one block of
+// text. This gives the same results as calling text.indexOf(pattern, index)
+// for every pattern at every step (as a QRegExp match at a given position
+// doesn't depend on where the search started), but each pattern is only
+// searched again once the text up to its previous match has been consumed.
+class NextMatchCache
+{
+public:
+	NextMatchCache(const QString& str, int count)
+		: text(str), matchIndex(count), matchLength(count)
+		{
+			for (int i = 0; i < count; ++i)
+				matchIndex[i] = kNotSearched;
+		}
+
+	// position of the first match of pattern i at or after index, or -1;
+	// the pattern's captures refer to this match
+	int next(int i, QRegExp& pattern, int index)
+		{
+			if (matchIndex[i] == kNotSearched || (matchIndex[i] >= 0 && matchIndex[i] < index)) {
+				matchIndex[i] = text.indexOf(pattern, index);
+				matchLength[i] = pattern.matchedLength();
+			}
+			return matchIndex[i];
+		}
+	int length(int i) const { return matchLength[i]; }
+
+private:
+	enum { kNotSearched = -2 };
+	const QString& text;
+	QVarLengthArray<int, 64> matchIndex;
+	QVarLengthArray<int, 64> matchLength;
+};
+
 void TeXHighlighter::highlightBlock(const QString &text)
 {
+#if QT_VERSION >= 0x040600
+	blockUncheckedWords.clear();
+	if (deferHighlighting) {
+		// keep the current formats (which would be cleared otherwise) until
+		// the block is done; the block state isn't changed either, so the
+		// following blocks are not reformatted
+		QTextLayout *layout = currentBlock().layout();
+		if (layout != NULL) {
+			foreach (const QTextLayout::FormatRange& range, layout->additionalFormats())
+				setFormat(range.start, range.length, range.format);
+		}
+		if (!isPending(currentBlock()))
+			setCurrentBlockUserData(new PendingBlockData);
+		return;
+	}
+	if (isPending(currentBlock()))
+		setCurrentBlockUserData(NULL);
+#endif
+
 	int index = 0;
 	if (highlightIndex >= 0 && highlightIndex < syntaxRules->count()) {
 		QList<HighlightingRule>& highlightingRules = (*syntaxRules)[highlightIndex].rules;
+		NextMatchCache matches(text, highlightingRules.size());
 		while (index < text.length()) {
-			int firstIndex = INT_MAX, len;
+			int firstIndex = INT_MAX, len = 0;
 			const HighlightingRule* firstRule = NULL;
 			for (int i = 0; i < highlightingRules.size(); ++i) {
-				HighlightingRule &rule = highlightingRules[i];
-				int foundIndex = text.indexOf(rule.pattern, index);
+				int foundIndex = matches.next(i, highlightingRules[i].pattern, index);
 				if (foundIndex >= 0 && foundIndex < firstIndex) {
 					firstIndex = foundIndex;
-					firstRule = &rule;
+					firstRule = &highlightingRules[i];
+					len = matches.length(i);
 				}
 			}
-			if (firstRule != NULL && (len = firstRule->pattern.matchedLength()) > 0) {
+			if (firstRule != NULL && len > 0) {
 				if (pHunspell != NULL && firstIndex > index)
 					spellCheckRange(text, index, firstIndex, spellFormat);
 				setFormat(firstIndex, len, firstRule->format);
@@ -95,42 +191,49 @@ void TeXHighlighter::highlightBlock(const QString &text)
 	}
 	if (pHunspell != NULL)
 		spellCheckRange(text, index, text.length(), spellFormat);
+#if QT_VERSION >= 0x040600
+	if (!blockUncheckedWords.isEmpty()) {
+		// the cursor follows the block when lines are inserted or removed
+		// before the words are checked
+		uncheckedWords << UncheckedBlock(QTextCursor(currentBlock()), blockUncheckedWords);
+		if (!spellRequestTimer.isActive())
+			spellRequestTimer.start();
+	}
+#endif
 
 #if QT_VERSION >= 0x040400	/* the currentBlock() method is not available in 4.3.x */
 	if (texDoc != NULL) {
-		bool changed = false;
-		if (texDoc->removeTags(currentBlock().position(), currentBlock().length()) > 0)
-			changed = true;
+		QList<TWTag> blockTags;
 		if (isTagging) {
 			int index = 0;
+			NextMatchCache matches(text, tagPatterns->count());
 			while (index < text.length()) {
-				int firstIndex = INT_MAX, len;
+				int firstIndex = INT_MAX, len = 0;
 				TagPattern* firstPatt = NULL;
 				for (int i = 0; i < tagPatterns->count(); ++i) {
-					TagPattern& patt = (*tagPatterns)[i];
-					int foundIndex = text.indexOf(patt.pattern, index);
+					int foundIndex = matches.next(i, (*tagPatterns)[i].pattern, index);
 					if (foundIndex >= 0 && foundIndex < firstIndex) {
 						firstIndex = foundIndex;
-						firstPatt = &patt;
+						firstPatt = &(*tagPatterns)[i];
+						len = matches.length(i);
 					}
 				}
-				if (firstPatt != NULL && (len = firstPatt->pattern.matchedLength()) > 0) {
+				if (firstPatt != NULL && len > 0) {
 					QTextCursor	cursor(document());
 					cursor.setPosition(currentBlock().position() + firstIndex);
 					cursor.setPosition(currentBlock().position() + firstIndex + len, QTextCursor::KeepAnchor);
 					QString text = firstPatt->pattern.cap(1);
 					if (text.isEmpty())
 						text = firstPatt->pattern.cap(0);
-					texDoc->addTag(cursor, firstPatt->level, text);
+					blockTags << TWTag(cursor, firstPatt->level, text);
 					index = firstIndex + len;
-					changed = true;
 				}
 				else
 					break;
 			}
 		}
-		if (changed)	
-			texDoc->tagsChanged();
+		// only notifies the tags dock if the block's tags are different
+		texDoc->tagIndex()->setTags(currentBlock().position(), currentBlock().length(), blockTags);
 	}
 #endif
 }
@@ -140,7 +243,75 @@ void TeXHighlighter::setActiveIndex(int index)
 	int oldIndex = highlightIndex;
 	highlightIndex = (index >= 0 && index < syntaxRules->count()) ? index : -1;
 	if (oldIndex != highlightIndex)
-		rehighlight();
+		rehighlightLazily();
+}
+
+void TeXHighlighter::setDeferHighlighting(bool defer)
+{
+#if QT_VERSION >= 0x040600
+	deferHighlighting = defer;
+	if (!defer) {
+		lazyHighlightBlock = 0;
+		lazyHighlightTimer.start();
+	}
+#else
+	Q_UNUSED(defer);
+#endif
+}
+
+void TeXHighlighter::rehighlightLazily()
+{
+#if QT_VERSION >= 0x040600
+	// the current formats stay until each block is done
+	for (QTextBlock block = document()->begin(); block.isValid(); block = block.next()) {
+		if (!isPending(block))
+			block.setUserData(new PendingBlockData);
+	}
+	lazyHighlightBlock = 0;
+	lazyHighlightTimer.start();
+#else
+	rehighlight();
+#endif
+}
+
+void TeXHighlighter::highlightPendingBlock(QTextBlock& block)
+{
+#if QT_VERSION >= 0x040600
+	if (!isPending(block))
+		return;
+	block.setUserData(NULL);
+	rehighlightBlock(block);
+#else
+	Q_UNUSED(block);
+#endif
+}
+
+void TeXHighlighter::highlightPendingBlocks()
+{
+	QTime time;
+	time.start();
+	if (texDoc != NULL)
+		texDoc->beginTagListChanges();
+
+	int firstVisible, lastVisible;
+	if (visibleBlocks(firstVisible, lastVisible)) {
+		QTextBlock block = document()->findBlockByNumber(firstVisible);
+		for (; block.isValid() && block.blockNumber() <= lastVisible; block = block.next())
+			highlightPendingBlock(block);
+	}
+
+	QTextBlock block = document()->findBlockByNumber(lazyHighlightBlock);
+	while (block.isValid() && time.elapsed() < kLazyHighlightSlice) {
+		highlightPendingBlock(block);
+		block = block.next();
+	}
+
+	if (texDoc != NULL)
+		texDoc->endTagListChanges();
+	if (block.isValid()) {
+		lazyHighlightBlock = block.blockNumber();
+		lazyHighlightTimer.start();
+	}
 }
 
 void TeXHighlighter::setSpellChecker(Hunhandle* h, QTextCodec* codec)
@@ -148,8 +319,106 @@ void TeXHighlighter::setSpellChecker(Hunhandle* h, QTextCodec* codec)
 	if (pHunspell != h || spellingCodec != codec) {
 		pHunspell = h;
 		spellingCodec = codec;
+#if QT_VERSION >= 0x040600
+		TWSpellChecker::instance()->cancelRequests(this);
+		uncheckedWords.clear();
+		spellRequests.clear();
+		rehighlightLazily();
+#else
 		QTimer::singleShot(1, this, SLOT(rehighlight()));
+#endif
+	}
+}
+
+bool TeXHighlighter::visibleBlocks(int& first, int& last) const
+{
+	if (texDoc == NULL)
+		return false;
+	texDoc->visibleLines(first, last);
+	// lines are numbered from 1, blocks from 0
+	--first;
+	--last;
+	return first <= last;
+}
+
+void TeXHighlighter::queueSpellCheck(TWSpellChecker::Channel channel, const QStringList& words, const QList<QTextCursor>& blocks)
+{
+	if (words.isEmpty())
+		return;
+	int id = TWSpellChecker::instance()->requestWords(this, channel, pHunspell, spellingCodec, words);
+	spellRequests.insert(id, blocks);
+}
+
+void TeXHighlighter::requestSpellChecks()
+{
+	if (pHunspell == NULL) {
+		uncheckedWords.clear();
+		return;
+	}
+
+	// words on screen are checked first; the rest is sent in batches so that
+	// underlines appear progressively
+	int firstVisible = 0, lastVisible = -1;
+	visibleBlocks(firstVisible, lastVisible);
+	QStringList visibleWords, words;
+	QList<QTextCursor> visibleBlockList, blockList;
+	foreach (const UncheckedBlock& unchecked, uncheckedWords) {
+		int blockNumber = unchecked.cursor.blockNumber();
+		if (blockNumber >= firstVisible && blockNumber <= lastVisible) {
+			visibleWords << unchecked.words;
+			visibleBlockList << unchecked.cursor;
+			continue;
+		}
+		words << unchecked.words;
+		blockList << unchecked.cursor;
+		if (words.size() >= kSpellCheckBatchSize) {
+			queueSpellCheck(TWSpellChecker::kBackgroundChannel, words, blockList);
+			words.clear();
+			blockList.clear();
+		}
+	}
+	queueSpellCheck(TWSpellChecker::kBackgroundChannel, words, blockList);
+	queueSpellCheck(TWSpellChecker::kVisibleChannel, visibleWords, visibleBlockList);
+	uncheckedWords.clear();
+}
+
+void TeXHighlighter::spellChecksDone(QObject *requester, int requestId)
+{
+	if (requester != this || !spellRequests.contains(requestId))
+		return;
+	rehighlightBlocks(spellRequests.take(requestId));
+}
+
+void TeXHighlighter::wordIgnored(Hunhandle *h, const QString& word)
+{
+	if (h != pHunspell)
+		return;
+	QList<QTextCursor> blocks;
+	QTextCursor cursor(document());
+	while (true) {
+		cursor = document()->find(word, cursor, QTextDocument::FindCaseSensitively | QTextDocument::FindWholeWords);
+		if (cursor.isNull())
+			break;
+		if (blocks.isEmpty() || blocks.last().block() != cursor.block())
+			blocks << cursor;
 	}
+	rehighlightBlocks(blocks);
+}
+
+void TeXHighlighter::rehighlightBlocks(const QList<QTextCursor>& blocks)
+{
+#if QT_VERSION >= 0x040600
+	QTextBlock previous;
+	foreach (const QTextCursor& cursor, blocks) {
+		QTextBlock block = cursor.block();
+		if (block.isValid() && block != previous)
+			rehighlightBlock(block);
+		previous = block;
+	}
+#else
+	Q_UNUSED(blocks);
+	rehighlight();
+#endif
 }
 
 QStringList TeXHighlighter::syntaxOptions()
@@ -25,13 +25,26 @@
 #include <QSyntaxHighlighter>
 
 #include <QTextCharFormat>
+#include <QTextCursor>
+#include <QTimer>
+#include <QMap>
+#include <QHash>
 
 #include <hunspell.h>
 
+#include "TWSpellChecker.h"
+
 class QTextDocument;
+class QTextBlock;
 class QTextCodec;
 class TeXDocument;
 
+// number of words sent to the spell checker thread in one background request
+const int kSpellCheckBatchSize = 500;
+// time (in ms) spent on highlighting pending blocks before returning to the
+// event loop
+const int kLazyHighlightSlice = 20;
+
 class TeXHighlighter : public QSyntaxHighlighter
 {
 	Q_OBJECT
@@ -42,6 +55,14 @@ public:
 	void setActiveIndex(int index);
 
 	void setSpellChecker(Hunhandle *h, QTextCodec *codec);
+	virtual ~TeXHighlighter();
+
+	// While deferred (e.g., when loading a file), blocks are only marked as
+	// pending and keep their formats; they are highlighted later, those on
+	// screen first and the rest in small chunks when the application is idle.
+	void setDeferHighlighting(bool defer);
+	// like rehighlight(), but using the same scheduling
+	void rehighlightLazily();
 
 	QString getSyntaxMode() const {
 		return (highlightIndex >= 0 && highlightIndex < syntaxOptions().size())
@@ -55,7 +76,18 @@ protected:
 
 	void spellCheckRange(const QString &text, int index, int limit, const QTextCharFormat &spellFormat);
 
+private slots:
+	void requestSpellChecks();
+	void spellChecksDone(QObject *requester, int requestId);
+	void wordIgnored(Hunhandle *h, const QString& word);
+	void highlightPendingBlocks();
+
 private:
+	void queueSpellCheck(TWSpellChecker::Channel channel, const QStringList& words, const QList<QTextCursor>& blocks);
+	void rehighlightBlocks(const QList<QTextCursor>& blocks);
+	bool visibleBlocks(int& first, int& last) const;
+	void highlightPendingBlock(QTextBlock& block);
+
 	static void loadPatterns();
 
 	struct HighlightingRule {
@@ -86,6 +118,27 @@ private:
 
 	Hunhandle	*pHunspell;
 	QTextCodec	*spellingCodec;
+
+	// Spell checking is done in the background by TWSpellChecker;
+	// highlightBlock() only uses cached results and collects the words that
+	// still need checking. Blocks are rehighlighted when their words are done;
+	// they are referred to by cursors, which follow them through edits.
+	struct UncheckedBlock {
+		UncheckedBlock(const QTextCursor& c, const QStringList& w)
+			: cursor(c), words(w) { }
+		QTextCursor	cursor;
+		QStringList	words;
+	};
+	QList<UncheckedBlock>	uncheckedWords;
+	QStringList	blockUncheckedWords;	// of the block being highlighted
+	QHash<int, QList<QTextCursor> >	spellRequests;	// request id -> blocks
+	QTimer	spellRequestTimer;
+
+	// blocks that still need highlighting carry a PendingBlockData (see
+	// TeXHighlighter.cpp); their state and their current formats are kept
+	bool	deferHighlighting;
+	QTimer	lazyHighlightTimer;
+	int		lazyHighlightBlock;	// where highlightPendingBlocks() continues
 };
 
 #endif
@@ -0,0 +1,176 @@
+/*
+	This is part of TeXworks, an environment for working with TeX documents
+	Copyright (C) 2007-2012  Jonathan Kew, Stefan Löffler, Charlie Sharpsteen
+
+	This program is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	For links to further information, or to contact the authors,
+	see <http://www.tug.org/texworks/>.
+*/
+
+
+// Compares forward and inverse searches in sample.pdf, made with SyncTeXIndex
+// the way PDFDocument makes them, with the results listed in expected.txt.
+// As the index is saved next to the PDF, the files are copied to a working
+// directory first.
+// Usage: SyncTeXCheck <directory of sample.pdf> <working directory>
+
+#include "SyncTeXIndex.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegExp>
+#include <QStringList>
+#include <QTextStream>
+
+static QString formatRects(const QList<QRectF>& rects)
+{
+	QStringList result;
+	foreach (const QRectF& rect, rects)
+		result << QString("[%1 %2 %3 %4]").arg(rect.x(), 0, 'f', 2).arg(rect.y(), 0, 'f', 2)
+					.arg(rect.width(), 0, 'f', 2).arg(rect.height(), 0, 'f', 2);
+	return result.join(" ");
+}
+
+// the old parser computed with floats, so the last digit may differ
+static bool sameRect(const QRectF& a, const QRectF& b)
+{
+	return qAbs(a.x() - b.x()) < 0.015 && qAbs(a.y() - b.y()) < 0.015 &&
+			qAbs(a.width() - b.width()) < 0.015 && qAbs(a.height() - b.height()) < 0.015;
+}
+
+// the order of the boxes doesn't matter
+static bool sameRects(const QList<QRectF>& expected, QList<QRectF> found)
+{
+	if (expected.size() != found.size())
+		return false;
+	foreach (const QRectF& rect, expected) {
+		int i = 0;
+		while (i < found.size() && !sameRect(rect, found[i]))
+			++i;
+		if (i == found.size())
+			return false;
+		found.removeAt(i);
+	}
+	return true;
+}
+
+// returns the number of queries with unexpected results
+static int check(const QString& pdfFileName, const QString& expectedFileName)
+{
+	QTextStream err(stderr);
+	SyncTeXIndexPointer index = SyncTeXIndex::load(pdfFileName);
+	if (!index) {
+		err << "no SyncTeX data for " << pdfFileName << endl;
+		return 1;
+	}
+	QFile expectedFile(expectedFileName);
+	if (!expectedFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+		err << "can't read " << expectedFileName << endl;
+		return 1;
+	}
+	QMap<QString, int> tags;
+	QMap<int, QString>::const_iterator input;
+	for (input = index->inputs().constBegin(); input != index->inputs().constEnd(); ++input)
+		tags.insert(QFileInfo(input.value()).fileName(), input.key());
+
+	QRegExp forwardQuery("(\\S+):(\\d+)");
+	QRegExp inverseQuery("(\\d+) (\\S+) (\\S+)");
+	QRegExp pageResult("page (\\d+):.*");
+	QRegExp rectResult("\\[(\\S+) (\\S+) (\\S+) (\\S+)\\]");
+	int failures = 0;
+	QTextStream in(&expectedFile);
+	while (!in.atEnd()) {
+		QString line = in.readLine();
+		int arrow = line.indexOf(" -> ");
+		// skip the headings
+		if (arrow < 0 || line.endsWith(':'))
+			continue;
+		QString query = line.left(arrow);
+		QString expected = line.mid(arrow + 4);
+		QString found;
+		bool ok = false;
+		if (forwardQuery.exactMatch(query)) {
+			QList<QRectF> rects;
+			int pageIdx = index->displayQuery(tags.value(forwardQuery.cap(1), -1), forwardQuery.cap(2).toInt(), rects);
+			if (pageIdx < 0)
+				found = "none";
+			else
+				found = QString("page %1: %2").arg(pageIdx + 1).arg(formatRects(rects));
+			if (pageResult.exactMatch(expected)) {
+				QList<QRectF> expectedRects;
+				for (int pos = 0; (pos = rectResult.indexIn(expected, pos)) >= 0; pos += rectResult.matchedLength())
+					expectedRects << QRectF(rectResult.cap(1).toDouble(), rectResult.cap(2).toDouble(),
+											rectResult.cap(3).toDouble(), rectResult.cap(4).toDouble());
+				ok = (pageResult.cap(1).toInt() == pageIdx + 1 && sameRects(expectedRects, rects));
+			}
+			else
+				ok = (found == expected);
+		}
+		else if (inverseQuery.exactMatch(query)) {
+			int tag, sourceLine;
+			QPointF pos(inverseQuery.cap(2).toDouble(), inverseQuery.cap(3).toDouble());
+			if (index->editQuery(inverseQuery.cap(1).toInt() - 1, pos, tag, sourceLine))
+				found = QString("%1:%2").arg(QFileInfo(index->inputs().value(tag)).fileName()).arg(sourceLine);
+			else
+				found = "none";
+			ok = (found == expected);
+		}
+		else
+			continue;
+		if (!ok) {
+			err << query << ": expected " << expected << ", found " << found << endl;
+			++failures;
+		}
+	}
+	return failures;
+}
+
+int main(int argc, char *argv[])
+{
+	QTextStream err(stderr);
+	if (argc != 3) {
+		err << "Usage: SyncTeXCheck <directory of sample.pdf> <working directory>" << endl;
+		return 2;
+	}
+	QDir source(QString::fromLocal8Bit(argv[1]));
+	QDir work(QString::fromLocal8Bit(argv[2]));
+	if (!work.mkpath(".")) {
+		err << "can't create " << work.path() << endl;
+		return 2;
+	}
+	// start without an index file
+	foreach (const QString& name, work.entryList(QDir::Files))
+		work.remove(name);
+	foreach (const QString& name, QStringList() << "sample.pdf" << "sample.synctex.gz") {
+		if (!QFile::copy(source.filePath(name), work.filePath(name))) {
+			err << "can't copy " << source.filePath(name) << endl;
+			return 2;
+		}
+	}
+
+	// the first pass scans the SyncTeX file and saves the index, the second
+	// one uses the saved index
+	QString pdfFileName = work.filePath("sample.pdf");
+	QString expectedFileName = source.filePath("expected.txt");
+	int failures = check(pdfFileName, expectedFileName);
+	failures += check(pdfFileName, expectedFileName);
+	if (failures > 0) {
+		err << failures << " queries differ from expected.txt" << endl;
+		return 1;
+	}
+	QTextStream(stdout) << "all queries match expected.txt" << endl;
+	return 0;
+}